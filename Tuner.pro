@@ -1,4 +1,4 @@
-QT       += core gui multimedia multimediawidgets # ДОБАВЛЕНО multimedia и multimediawidgets
+QT       += core gui multimedia multimediawidgets concurrent # ДОБАВЛЕНО multimedia и multimediawidgets
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -6,16 +6,61 @@ CONFIG += c++17
 
 SOURCES += \
     qtaudiorecorder.cpp \
+    decimator.cpp \
+    driftlogwriter.cpp \
+    graphstages.cpp \
+    idlemonitor.cpp \
+    inharmonicityanalyzer.cpp \
+    instrumentprofile.cpp \
     main.cpp \
     mainwindow.cpp \
+    multichanneldetector.cpp \
     noteconverter.cpp \
-    pitchdetector.cpp
+    offlineanalyzer.cpp \
+    partialsworker.cpp \
+    pitchdetector.cpp \
+    pitchstreampublisher.cpp \
+    prefilter.cpp \
+    realtimesupport.cpp \
+    runningstatistics.cpp \
+    processinggraph.cpp \
+    pitchtracker.cpp \
+    slidingdifference.cpp \
+    spectraldifference.cpp \
+    tonegenerator.cpp \
+    tuningstatistics.cpp \
+    wavetable.cpp \
+    yinkernel.cpp
 
 HEADERS += \
     qtaudiorecorder.h \
+    decimator.h \
+    driftlogwriter.h \
+    graphstages.h \
+    idlemonitor.h \
+    inharmonicityanalyzer.h \
+    instrumentprofile.h \
     mainwindow.h \
+    multichanneldetector.h \
     noteconverter.h \
-    pitchdetector.h
+    offlineanalyzer.h \
+    partialsworker.h \
+    pitchdetector.h \
+    pitchstream.h \
+    pitchstreampublisher.h \
+    prefilter.h \
+    realtimesupport.h \
+    runningstatistics.h \
+    pitchtracker.h \
+    slidingdifference.h \
+    spectraldifference.h \
+    processinggraph.h \
+    simdfloat.h \
+    spscqueue.h \
+    tonegenerator.h \
+    tuningstatistics.h \
+    wavetable.h \
+    yinkernel.h
 
 FORMS += \
     mainwindow.ui
@@ -0,0 +1,148 @@
+#include "batchedpitchengine.h"
+#include "simdfloat.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int MAX_VECTORS = 4;
+
+// Число векторов известно при компиляции, чтобы аккумуляторы жили в регистрах
+template <int Vectors>
+void groupDifference(const float* x, float* diff, int integrationLength, int maxLag)
+{
+    const int lanes = Vectors * SimdFloat4::LANES;
+    for (int v = 0; v < Vectors; ++v) SimdFloat4::zero().store(diff + v * 4);
+    for (int tau = 1; tau <= maxLag + 1; ++tau) {
+        SimdFloat4 acc[Vectors];
+        for (int v = 0; v < Vectors; ++v) acc[v] = SimdFloat4::zero();
+
+        const float* a = x;
+        const float* b = x + size_t(tau) * lanes;
+        for (int j = 0; j < integrationLength; ++j) {
+            for (int v = 0; v < Vectors; ++v) {
+                SimdFloat4 d = SimdFloat4::load(a + v * 4) - SimdFloat4::load(b + v * 4);
+                acc[v] = acc[v] + d * d;
+            }
+            a += lanes;
+            b += lanes;
+        }
+        for (int v = 0; v < Vectors; ++v) acc[v].store(diff + size_t(tau) * lanes + v * 4);
+    }
+}
+}
+
+BatchedPitchEngine::BatchedPitchEngine(int streamCount, float sampleRate, int windowSize, int hopSize,
+                                       float minFrequency, float maxFrequency, int lanesPerGroup)
+    : streams(streamCount),
+    window(windowSize),
+    hop(hopSize),
+    kernel(windowSize, sampleRate, minFrequency, maxFrequency),
+    position(0)
+{
+    vectors = std::max(1, std::min(MAX_VECTORS, lanesPerGroup / SimdFloat4::LANES));
+    lanes = vectors * SimdFloat4::LANES;
+    groups = streams / lanes;
+
+    groupHistory.resize(groups);
+    groupScratch.resize(size_t(kernel.scratchSize()) * lanes);
+    laneScratch.resize(kernel.scratchSize());
+    singleHistory.resize(streams - groups * lanes);
+    singleScratch.resize(kernel.scratchSize());
+    reset();
+}
+
+void BatchedPitchEngine::reset()
+{
+    position = 0;
+    for (std::vector<float>& h : groupHistory) {
+        h.assign(size_t(2 * window) * lanes, 0.0f);
+    }
+    for (std::vector<float>& h : singleHistory) {
+        h.assign(size_t(2 * window), 0.0f);
+    }
+}
+
+void BatchedPitchEngine::selectPitch(const PitchCandidate* candidates, int count, float* pitch, float* confidence)
+{
+    // Без трекера берём наиболее вероятного кандидата, как MultiChannelPitchDetector
+    float best = 0.0f;
+    float bestProbability = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        if (candidates[i].probability > bestProbability) {
+            bestProbability = candidates[i].probability;
+            best = candidates[i].frequency;
+        }
+    }
+    *pitch = best;
+    if (confidence) *confidence = bestProbability;
+}
+
+void BatchedPitchEngine::process(const float* const* hops, float* pitches, float* confidences)
+{
+    for (int group = 0; group < groups; ++group) {
+        processGroup(group, hops, pitches, confidences);
+    }
+    for (int stream = groups * lanes; stream < streams; ++stream) {
+        processSingle(stream, hops[stream], &pitches[stream], confidences ? &confidences[stream] : nullptr);
+    }
+
+    // Все потоки идут синхронно, позиция записи общая
+    position = (position + hop) % window;
+}
+
+void BatchedPitchEngine::processGroup(int group, const float* const* hops, float* pitches, float* confidences)
+{
+    const int first = group * lanes;
+    float* history = groupHistory[group].data();
+
+    // Транспонирование: отсчёт i потока lane -> history[i][lane], с зеркалом на window
+    int p = position;
+    for (int i = 0; i < hop; ++i) {
+        float* row = history + size_t(p) * lanes;
+        float* mirror = history + size_t(p + window) * lanes;
+        for (int lane = 0; lane < lanes; ++lane) {
+            row[lane] = mirror[lane] = hops[first + lane][i];
+        }
+        if (++p == window) p = 0;
+    }
+
+    const float* x = history + size_t(p) * lanes;
+    float* diff = groupScratch.data();
+    const int integrationLength = kernel.integrationSize();
+    const int maxLag = kernel.maximumLag();
+
+    // Разностная функция: каждый канал вектора — свой поток; лаги — как у ядра
+    switch (vectors) {
+    case 1: groupDifference<1>(x, diff, integrationLength, maxLag); break;
+    case 2: groupDifference<2>(x, diff, integrationLength, maxLag); break;
+    default: groupDifference<4>(x, diff, integrationLength, maxLag); break;
+    }
+
+    // Нормировка и голосование порогов последовательные — по столбцу на поток
+    const int size = kernel.scratchSize();
+    for (int lane = 0; lane < lanes; ++lane) {
+        for (int tau = 0; tau < size; ++tau) {
+            laneScratch[tau] = diff[size_t(tau) * lanes + lane];
+        }
+        PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+        const int count = kernel.candidatesFromDifference(laneScratch.data(), candidates,
+                                                          YinKernel::MAX_CANDIDATES);
+        selectPitch(candidates, count, &pitches[first + lane],
+                    confidences ? &confidences[first + lane] : nullptr);
+    }
+}
+
+void BatchedPitchEngine::processSingle(int stream, const float* samples, float* pitch, float* confidence)
+{
+    float* history = singleHistory[stream - groups * lanes].data();
+
+    int p = position;
+    for (int i = 0; i < hop; ++i) {
+        history[p] = history[p + window] = samples[i];
+        if (++p == window) p = 0;
+    }
+
+    PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+    const int count = kernel.analyze(history + p, singleScratch.data(), candidates, YinKernel::MAX_CANDIDATES);
+    selectPitch(candidates, count, pitch, confidence);
+}
@@ -0,0 +1,58 @@
+#ifndef BATCHEDPITCHENGINE_H
+#define BATCHEDPITCHENGINE_H
+
+#include <vector>
+#include "yinkernel.h"
+
+// Пакетная обработка многих потоков: хопы 4/8/16 потоков транспонируются так,
+// что каждый канал SIMD-вектора несёт свой поток, и разностная функция YIN
+// считается для всей группы синхронно. Кандидаты (нормировка, голосование
+// порогов) выбираются тем же YinKernel, что и в PitchDetector, с границами
+// лагов по диапазону частот. Потоки, не вошедшие в полные группы,
+// обрабатываются по одному тем же ядром.
+//
+// В приложение не входит: выигрыш против специализированного ядра YinKernel
+// по одному потоку зависит от машины, сравнение — бенчмарки в tests/batchedpitchengine.
+class BatchedPitchEngine
+{
+public:
+    BatchedPitchEngine(int streams, float sampleRate, int windowSize, int hopSize,
+                       float minFrequency = 0.0f, float maxFrequency = 0.0f, int lanesPerGroup = 8);
+
+    void reset();
+
+    // hops[stream] — hopSize новых отсчётов каждого потока.
+    // pitches — самый вероятный кандидат потока (0 — нет сигнала),
+    // confidences — его вероятность (может быть nullptr).
+    void process(const float* const* hops, float* pitches, float* confidences);
+
+    int streamCount() const { return streams; }
+    int lanesPerGroup() const { return lanes; }
+    int groupCount() const { return groups; }
+    int leftoverCount() const { return streams - groups * lanes; }
+
+private:
+    void processGroup(int group, const float* const* hops, float* pitches, float* confidences);
+    void processSingle(int stream, const float* hop, float* pitch, float* confidence);
+    static void selectPitch(const PitchCandidate* candidates, int count, float* pitch, float* confidence);
+
+    int streams;
+    int window;
+    int hop;
+    YinKernel kernel;
+    int lanes;
+    int vectors;
+    int groups;
+    int position;
+
+    // Группы: зеркальная история [2 * window][lanes] и рабочий буфер [scratchSize][lanes]
+    std::vector<std::vector<float>> groupHistory;
+    std::vector<float> groupScratch;
+    // Столбец одного потока из groupScratch для выбора кандидатов
+    std::vector<float> laneScratch;
+    // Оставшиеся потоки: [2 * window] и [scratchSize]
+    std::vector<std::vector<float>> singleHistory;
+    std::vector<float> singleScratch;
+};
+
+#endif // BATCHEDPITCHENGINE_H
@@ -0,0 +1,114 @@
+#include "decimator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double PI = 3.14159265358979323846;
+const int TAPS_PER_PHASE = 24;
+// Детектору нужна основная частота и несколько гармоник
+const float HARMONIC_MARGIN = 3.0f;
+
+int tapCountFor(int factor)
+{
+    return TAPS_PER_PHASE * factor + 1;
+}
+
+double cutoffFor(int factor)
+{
+    // Срез (в долях входной частоты) ставится так, чтобы переходная полоса
+    // окна Блэкмана (~5.5 / N) закончилась на новой частоте Найквиста
+    double transition = 5.5 / tapCountFor(factor);
+    return 0.5 / factor - transition / 2.0;
+}
+}
+
+PolyphaseDecimator::PolyphaseDecimator()
+    : decimation(1),
+    phase(0)
+{
+}
+
+void PolyphaseDecimator::configure(int factor)
+{
+    decimation = std::max(1, factor);
+    reversedTaps.clear();
+    buffer.clear();
+    phase = 0;
+
+    if (decimation == 1) return;
+
+    // ФНЧ методом окна: sinc * Блэкман, коэффициент передачи 1 на нуле
+    const int taps = tapCountFor(decimation);
+    const double cutoff = cutoffFor(decimation);
+    std::vector<double> h(taps);
+    double sum = 0.0;
+    for (int n = 0; n < taps; ++n) {
+        double m = n - (taps - 1) / 2.0;
+        double sinc = m == 0.0 ? 2.0 * cutoff : std::sin(2.0 * PI * cutoff * m) / (PI * m);
+        double window = 0.42 - 0.5 * std::cos(2.0 * PI * n / (taps - 1))
+                        + 0.08 * std::cos(4.0 * PI * n / (taps - 1));
+        h[n] = sinc * window;
+        sum += h[n];
+    }
+
+    // Храним в обратном порядке, чтобы свёртка шла по памяти подряд
+    reversedTaps.resize(taps);
+    for (int n = 0; n < taps; ++n) {
+        reversedTaps[n] = float(h[taps - 1 - n] / sum);
+    }
+    reset();
+}
+
+void PolyphaseDecimator::reset()
+{
+    phase = 0;
+    buffer.assign(reversedTaps.empty() ? 0 : reversedTaps.size() - 1, 0.0f);
+}
+
+int PolyphaseDecimator::process(const float* in, int count, float* out)
+{
+    if (decimation == 1) {
+        std::copy(in, in + count, out);
+        return count;
+    }
+
+    const int taps = int(reversedTaps.size());
+    const int history = taps - 1;
+    buffer.resize(history + count);
+    std::copy(in, in + count, buffer.begin() + history);
+
+    // buffer[n .. n + history] — окно фильтра, заканчивающееся на in[n]
+    int produced = 0;
+    int n = phase;
+    for (; n < count; n += decimation) {
+        const float* x = &buffer[n];
+        float acc = 0.0f;
+        for (int k = 0; k < taps; ++k) {
+            acc += reversedTaps[k] * x[k];
+        }
+        out[produced++] = acc;
+    }
+    phase = n - count;
+
+    std::copy(buffer.end() - history, buffer.end(), buffer.begin());
+    buffer.resize(history);
+    return produced;
+}
+
+float PolyphaseDecimator::passbandEdge(float sampleRate, int factor)
+{
+    if (factor <= 1) return sampleRate / 2.0f;
+    double transition = 5.5 / tapCountFor(factor);
+    return float((cutoffFor(factor) - transition / 2.0) * sampleRate);
+}
+
+int PolyphaseDecimator::factorForRange(float sampleRate, float maxFrequency, int hopSize)
+{
+    const float required = maxFrequency * HARMONIC_MARGIN;
+    for (int factor = 8; factor > 1; factor /= 2) {
+        if (hopSize % factor == 0 && passbandEdge(sampleRate, factor) >= required) {
+            return factor;
+        }
+    }
+    return 1;
+}
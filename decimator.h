@@ -0,0 +1,36 @@
+#ifndef DECIMATOR_H
+#define DECIMATOR_H
+
+#include <vector>
+
+// Полифазный децимирующий фильтр (понижение частоты в 2/4/8 раз).
+// Вычисляются только те выходы ФНЧ, которые остаются после прореживания,
+// поэтому стоимость на входной отсчёт — taps / factor умножений.
+class PolyphaseDecimator
+{
+public:
+    PolyphaseDecimator();
+
+    void configure(int factor);
+    void reset();
+
+    // Возвращает число выходных отсчётов (до count / factor + 1)
+    int process(const float* in, int count, float* out);
+
+    int factor() const { return decimation; }
+    int tapCount() const { return int(reversedTaps.size()); }
+
+    // Полоса, которую фильтр пропускает без заметных искажений
+    static float passbandEdge(float sampleRate, int factor);
+    // Наибольший из 1/2/4/8, при котором полоса покрывает maxFrequency
+    // вместе с гармониками, нужными детектору
+    static int factorForRange(float sampleRate, float maxFrequency, int hopSize);
+
+private:
+    int decimation;
+    int phase;
+    std::vector<float> reversedTaps;
+    std::vector<float> buffer;
+};
+
+#endif // DECIMATOR_H
@@ -0,0 +1,77 @@
+#include "driftlogwriter.h"
+#include <QDebug>
+#include <QTextStream>
+
+static const char* DRIFT_LOG_HEADER =
+    "time_ms,string,count,mean_cents,stddev_cents,p5_cents,p50_cents,p95_cents,"
+    "total_count,total_mean_cents,total_stddev_cents,rejected,total_rejected\n";
+
+DriftLogWriter::DriftLogWriter(QObject *parent)
+    : QObject(parent),
+    maxFileBytes(0)
+{
+}
+
+bool DriftLogWriter::open(const QString& path, qint64 maxBytes)
+{
+    filePath = path;
+    maxFileBytes = maxBytes;
+    return reopen();
+}
+
+bool DriftLogWriter::reopen()
+{
+    file.setFileName(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Cannot open drift log" << filePath << file.errorString();
+        return false;
+    }
+    // Продолжение прежнего журнала заголовок не повторяет
+    if (file.size() == 0) file.write(DRIFT_LOG_HEADER);
+    return true;
+}
+
+void DriftLogWriter::rotate()
+{
+    file.close();
+    const QString previous = filePath + ".1";
+    QFile::remove(previous);
+    if (!QFile::rename(filePath, previous)) {
+        qWarning() << "Cannot rotate drift log" << filePath;
+        QFile::remove(filePath);
+    }
+    reopen();
+}
+
+void DriftLogWriter::write(const QVector<DriftRecord>& records)
+{
+    if (!file.isOpen() || records.isEmpty()) return;
+
+    QString lines;
+    QTextStream stream(&lines);
+    for (const DriftRecord& record : records) {
+        stream << record.timeMs << ',' << record.string << ',' << record.count << ','
+               << QString::number(record.meanCents, 'f', 2) << ','
+               << QString::number(record.stdDevCents, 'f', 2) << ','
+               << QString::number(record.p5Cents, 'f', 2) << ','
+               << QString::number(record.medianCents, 'f', 2) << ','
+               << QString::number(record.p95Cents, 'f', 2) << ','
+               << record.totalCount << ','
+               << QString::number(record.totalMeanCents, 'f', 2) << ','
+               << QString::number(record.totalStdDevCents, 'f', 2) << ','
+               << record.rejected << ',' << record.totalRejected << '\n';
+    }
+    stream.flush();
+
+    if (maxFileBytes > 0 && file.size() + lines.size() > maxFileBytes) rotate();
+    if (!file.isOpen()) return;
+
+    file.write(lines.toUtf8());
+    // Журнал многочасовой: после сбоя должно остаться всё, кроме последнего интервала
+    file.flush();
+}
+
+void DriftLogWriter::close()
+{
+    if (file.isOpen()) file.close();
+}
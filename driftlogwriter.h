@@ -0,0 +1,51 @@
+#ifndef DRIFTLOGWRITER_H
+#define DRIFTLOGWRITER_H
+
+#include <QObject>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// Строка журнала дрейфа: статистика одной струны за интервал и за всё время
+struct DriftRecord {
+    qint64 timeMs = 0;          // Конец интервала, мс от эпохи
+    QString string;
+    long long count = 0;        // Показаний за интервал
+    float meanCents = 0.0f;
+    float stdDevCents = 0.0f;
+    float p5Cents = 0.0f;
+    float medianCents = 0.0f;
+    float p95Cents = 0.0f;
+    long long totalCount = 0;
+    float totalMeanCents = 0.0f;
+    float totalStdDevCents = 0.0f;
+    long long rejected = 0;     // Дальше ±50 ц от ноты за интервал, в статистику не вошли
+    long long totalRejected = 0;
+};
+
+// Запись журнала в отдельном потоке. Файл — CSV, при превышении maxBytes
+// он переименовывается в <path>.1 (старый .1 удаляется) и начинается заново,
+// так что на диске не больше двух файлов.
+class DriftLogWriter : public QObject
+{
+    Q_OBJECT
+public:
+    explicit DriftLogWriter(QObject *parent = nullptr);
+
+    // Вызывается до переноса в поток, чтобы ошибку можно было показать сразу
+    bool open(const QString& path, qint64 maxBytes);
+
+public slots:
+    void write(const QVector<DriftRecord>& records);
+    void close();
+
+private:
+    bool reopen();
+    void rotate();
+
+    QFile file;
+    QString filePath;
+    qint64 maxFileBytes;
+};
+
+#endif // DRIFTLOGWRITER_H
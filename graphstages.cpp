@@ -0,0 +1,174 @@
+#include "graphstages.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+
+bool ConverterStage::process(AudioFrame& frame)
+{
+    if (frame.raw.isEmpty()) return !frame.samples.empty();
+
+    const int channels = std::max(1, frame.format.channelCount());
+    const int bytesPerSample = frame.format.bytesPerSample();
+    if (bytesPerSample <= 0) return false;
+
+    const int frames = int(frame.raw.size()) / (bytesPerSample * channels);
+    const char* data = frame.raw.constData();
+    frame.samples.resize(frames);
+
+    for (int i = 0; i < frames; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c) {
+            const char* p = data + (size_t(i) * channels + c) * bytesPerSample;
+            switch (frame.format.sampleFormat()) {
+            case QAudioFormat::UInt8:
+                sum += (quint8(*p) - 128) / 128.0f;
+                break;
+            case QAudioFormat::Int16:
+                sum += qFromUnaligned<qint16>(p) / 32768.0f;
+                break;
+            case QAudioFormat::Int32:
+                sum += qFromUnaligned<qint32>(p) / 2147483648.0f;
+                break;
+            case QAudioFormat::Float:
+                sum += qFromUnaligned<float>(p);
+                break;
+            default:
+                return false;
+            }
+        }
+        frame.samples[i] = sum / channels;
+    }
+
+    frame.sampleRate = float(frame.format.sampleRate());
+    frame.raw.clear();
+    return true;
+}
+
+PreFilterStage::PreFilterStage(const PreFilter::Settings& settings)
+    : ProcessingStage("prefilter"),
+    settings(settings),
+    configuredRate(0.0f)
+{
+}
+
+void PreFilterStage::reset()
+{
+    configuredRate = 0.0f;
+}
+
+bool PreFilterStage::process(AudioFrame& frame)
+{
+    if (frame.sampleRate != configuredRate) {
+        filter.configure(settings, frame.sampleRate);
+        configuredRate = frame.sampleRate;
+    }
+    filter.process(frame.samples.data(), int(frame.samples.size()));
+    return true;
+}
+
+DecimatorStage::DecimatorStage(int factor)
+    : ProcessingStage("decimator")
+{
+    decimator.configure(factor);
+}
+
+bool DecimatorStage::process(AudioFrame& frame)
+{
+    if (decimator.factor() == 1) return true;
+
+    output.resize(frame.samples.size() / decimator.factor() + 1);
+    int produced = decimator.process(frame.samples.data(), int(frame.samples.size()), output.data());
+    frame.samples.assign(output.begin(), output.begin() + produced);
+    frame.sampleRate /= decimator.factor();
+    return true;
+}
+
+DetectorStage::DetectorStage(float windowSeconds, float minFrequency, float maxFrequency)
+    : ProcessingStage("detector"),
+    windowSeconds(windowSeconds),
+    minFrequency(minFrequency),
+    maxFrequency(maxFrequency)
+{
+}
+
+void DetectorStage::reset()
+{
+    kernel.reset();
+    window.clear();
+}
+
+bool DetectorStage::process(AudioFrame& frame)
+{
+    if (!kernel || kernel->sampleRate() != frame.sampleRate) {
+        int size = int(std::lround(windowSeconds * frame.sampleRate));
+        kernel.reset(new YinKernel(size, frame.sampleRate, minFrequency, maxFrequency));
+        window.assign(size, 0.0f);
+    }
+
+    const int hop = std::min(int(frame.samples.size()), int(window.size()));
+    std::move(window.begin() + hop, window.end(), window.begin());
+    std::copy(frame.samples.end() - hop, frame.samples.end(), window.end() - hop);
+
+    frame.candidateCount = kernel->analyze(window.data(), frame.candidates, YinKernel::MAX_CANDIDATES);
+
+    // Без трекера — наиболее вероятный кандидат
+    frame.pitchHz = 0.0f;
+    frame.confidence = 0.0f;
+    for (int i = 0; i < frame.candidateCount; ++i) {
+        if (frame.candidates[i].probability > frame.confidence) {
+            frame.confidence = frame.candidates[i].probability;
+            frame.pitchHz = frame.candidates[i].frequency;
+        }
+    }
+    return true;
+}
+
+TrackerStage::TrackerStage(const PitchTracker::Settings& settings)
+    : ProcessingStage("tracker"),
+    tracker(settings)
+{
+}
+
+bool TrackerStage::process(AudioFrame& frame)
+{
+    float trackedHz = 0.0f;
+    float confidence = 0.0f;
+    if (!tracker.push(frame.candidates, frame.candidateCount, trackedHz, confidence)) {
+        confidence = 0.0f;
+    }
+    frame.pitchHz = trackedHz;
+    frame.confidence = confidence;
+    return true;
+}
+
+SmootherStage::SmootherStage(int length)
+    : ProcessingStage("smoother"),
+    length(std::max(1, length))
+{
+}
+
+bool SmootherStage::process(AudioFrame& frame)
+{
+    if (frame.pitchHz <= 0.0f) {
+        recent.clear();
+        return true;
+    }
+
+    recent.push_back(frame.pitchHz);
+    if (int(recent.size()) > length) {
+        recent.erase(recent.begin());
+    }
+
+    float sorted[64];
+    const int count = std::min(int(recent.size()), 64);
+    std::copy(recent.end() - count, recent.end(), sorted);
+    std::nth_element(sorted, sorted + count / 2, sorted + count);
+    frame.pitchHz = sorted[count / 2];
+    return true;
+}
+
+bool SinkStage::process(AudioFrame& frame)
+{
+    if (callback) callback(frame);
+    return true;
+}
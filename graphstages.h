@@ -0,0 +1,101 @@
+#ifndef GRAPHSTAGES_H
+#define GRAPHSTAGES_H
+
+#include <functional>
+#include <memory>
+#include "processinggraph.h"
+#include "decimator.h"
+#include "pitchtracker.h"
+#include "prefilter.h"
+
+// Сырые данные устройства (UInt8/Int16/Int32/Float, любое число каналов) -> моно float
+class ConverterStage : public ProcessingStage
+{
+public:
+    ConverterStage() : ProcessingStage("converter") {}
+    bool process(AudioFrame& frame) override;
+};
+
+class PreFilterStage : public ProcessingStage
+{
+public:
+    explicit PreFilterStage(const PreFilter::Settings& settings);
+    bool process(AudioFrame& frame) override;
+    void reset() override;
+    int cost() const override { return 2; }
+
+private:
+    PreFilter::Settings settings;
+    PreFilter filter;
+    float configuredRate;
+};
+
+class DecimatorStage : public ProcessingStage
+{
+public:
+    explicit DecimatorStage(int factor);
+    bool process(AudioFrame& frame) override;
+    void reset() override { decimator.reset(); }
+    int cost() const override { return 2; }
+
+private:
+    PolyphaseDecimator decimator;
+    std::vector<float> output;
+};
+
+// YIN-кандидаты по скользящему окну; windowSeconds — длительность окна
+class DetectorStage : public ProcessingStage
+{
+public:
+    // minFrequency/maxFrequency — диапазон поиска YIN (0 — без ограничения)
+    explicit DetectorStage(float windowSeconds, float minFrequency = 0.0f, float maxFrequency = 0.0f);
+    bool process(AudioFrame& frame) override;
+    void reset() override;
+    int cost() const override { return 20; }
+
+private:
+    float windowSeconds;
+    float minFrequency;
+    float maxFrequency;
+    std::unique_ptr<YinKernel> kernel;
+    std::vector<float> window;
+};
+
+class TrackerStage : public ProcessingStage
+{
+public:
+    explicit TrackerStage(const PitchTracker::Settings& settings);
+    bool process(AudioFrame& frame) override;
+    void reset() override { tracker.reset(); }
+    int cost() const override { return 4; }
+
+private:
+    PitchTracker tracker;
+};
+
+// Медиана последних вокализованных значений
+class SmootherStage : public ProcessingStage
+{
+public:
+    explicit SmootherStage(int length = 5);
+    bool process(AudioFrame& frame) override;
+    void reset() override { recent.clear(); }
+
+private:
+    int length;
+    std::vector<float> recent;
+};
+
+// Конечная стадия: передаёт кадр в произвольную функцию (вызывается в потоке графа)
+class SinkStage : public ProcessingStage
+{
+public:
+    SinkStage(const QString& name, std::function<void(const AudioFrame&)> callback)
+        : ProcessingStage(name), callback(callback) {}
+    bool process(AudioFrame& frame) override;
+
+private:
+    std::function<void(const AudioFrame&)> callback;
+};
+
+#endif // GRAPHSTAGES_H
@@ -0,0 +1,102 @@
+#include "idlemonitor.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+
+IdleMonitor::IdleMonitor()
+    : enterPower(0.0f),
+    exitPower(0.0f),
+    holdHops(0),
+    silentHops(0),
+    skippedHops(0),
+    idle(false),
+    levelDb(-120.0f)
+{
+}
+
+void IdleMonitor::configure(const Settings& newSettings, float sampleRate, int hopSize)
+{
+    settings = newSettings;
+    settings.stride = std::max(1, settings.stride);
+    settings.idleCheckHops = std::max(1, settings.idleCheckHops);
+    settings.exitLevelDb = std::max(settings.exitLevelDb, settings.enterLevelDb);
+
+    // Уровни в dBFS по среднему квадрату
+    enterPower = std::pow(10.0f, settings.enterLevelDb / 10.0f);
+    exitPower = std::pow(10.0f, settings.exitLevelDb / 10.0f);
+    holdHops = std::max(1, int(std::ceil(settings.holdSeconds * sampleRate / hopSize)));
+    reset();
+}
+
+void IdleMonitor::reset()
+{
+    silentHops = 0;
+    skippedHops = 0;
+    idle = false;
+    levelDb = -120.0f;
+}
+
+float IdleMonitor::meanSquare(const char* data, int frames, const QAudioFormat& format) const
+{
+    // Берём только первый канал: для решения "есть звук или нет" этого достаточно
+    const int frameBytes = format.bytesPerFrame();
+    const int step = settings.stride * frameBytes;
+    const int count = (frames + settings.stride - 1) / settings.stride;
+    if (count == 0 || frameBytes <= 0) return 0.0f;
+
+    float sum = 0.0f;
+    const char* p = data;
+    for (int i = 0; i < count; ++i, p += step) {
+        float x;
+        switch (format.sampleFormat()) {
+        case QAudioFormat::UInt8:
+            x = (quint8(*p) - 128) / 128.0f;
+            break;
+        case QAudioFormat::Int16:
+            x = qFromUnaligned<qint16>(p) / 32768.0f;
+            break;
+        case QAudioFormat::Int32:
+            x = qFromUnaligned<qint32>(p) / 2147483648.0f;
+            break;
+        case QAudioFormat::Float:
+            x = qFromUnaligned<float>(p);
+            break;
+        default:
+            // Неизвестный формат: не мешаем обработке
+            return exitPower;
+        }
+        sum += x * x;
+    }
+    return sum / count;
+}
+
+bool IdleMonitor::update(const char* data, int frames, const QAudioFormat& format, bool& stateChanged)
+{
+    stateChanged = false;
+    if (!settings.enabled) return true;
+
+    if (idle && ++skippedHops < settings.idleCheckHops) return false;
+    skippedHops = 0;
+
+    const float power = meanSquare(data, frames, format);
+    levelDb = 10.0f * std::log10(std::max(power, 1e-12f));
+
+    if (idle) {
+        if (power < exitPower) return false;
+        idle = false;
+        silentHops = 0;
+        stateChanged = true;
+        return true;
+    }
+
+    if (power < enterPower) {
+        if (++silentHops >= holdHops) {
+            idle = true;
+            stateChanged = true;
+            return false;
+        }
+    } else {
+        silentHops = 0;
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef IDLEMONITOR_H
+#define IDLEMONITOR_H
+
+#include <QAudioFormat>
+
+// Энергетический детектор тишины для экономичного режима.
+// Пока инструмент не звучит, полноценный анализ не нужен: после holdSeconds
+// тишины монитор переходит в простой, и хопы перестают уходить в детектор.
+// Энергия оценивается по каждому stride-му отсчёту прямо в исходном формате,
+// поэтому проверка хопа почти ничего не стоит. Выход из простоя — в том же
+// хопе, где энергия превысила порог (с гистерезисом).
+class IdleMonitor
+{
+public:
+    struct Settings {
+        bool enabled = true;
+        float enterLevelDb = -60.0f; // Ниже этого уровня хоп считается тишиной
+        float exitLevelDb = -54.0f;  // Выше — сигнал, анализ возобновляется
+        float holdSeconds = 2.0f;    // Сколько тишины нужно для перехода в простой
+        int stride = 4;              // Прореживание отсчётов при оценке энергии
+        // В простое энергия оценивается раз в столько хопов. Больше 1 — только по
+        // желанию: пропущенные хопы отбрасываются, и начало звука может потеряться
+        int idleCheckHops = 1;
+    };
+
+    IdleMonitor();
+
+    void configure(const Settings& settings, float sampleRate, int hopSize);
+    void reset();
+
+    // Оценивает хоп; true — хоп нужно анализировать. При idleCheckHops > 1 в простое
+    // остальные хопы отбрасываются без чтения, выход — с задержкой до idleCheckHops хопов.
+    // stateChanged выставляется при переходе в простой или выходе из него.
+    bool update(const char* data, int frames, const QAudioFormat& format, bool& stateChanged);
+
+    bool isIdle() const { return idle; }
+    float lastLevelDb() const { return levelDb; }
+
+private:
+    float meanSquare(const char* data, int frames, const QAudioFormat& format) const;
+
+    Settings settings;
+    float enterPower;
+    float exitPower;
+    int holdHops;
+    int silentHops;
+    int skippedHops;
+    bool idle;
+    float levelDb;
+};
+
+#endif // IDLEMONITOR_H
@@ -0,0 +1,174 @@
+#include "inharmonicityanalyzer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Полоса поиска партиала вокруг предсказания
+const float SEARCH_CENTS = 60.0f;
+// Партиалы слабее самого сильного больше чем на столько — шум
+const float DYNAMIC_RANGE_DB = 70.0f;
+
+float cents(float ratio)
+{
+    return 1200.0f * std::log2(ratio);
+}
+}
+
+InharmonicityAnalyzer::InharmonicityAnalyzer(float sampleRate, int windowSize, int padFactor, int maxPartials)
+    : rate(sampleRate),
+    window(windowSize),
+    fftSize(windowSize * std::max(1, padFactor)),
+    maxPartials(std::clamp(maxPartials, 1, int(PartialsResult::MAX_PARTIALS))),
+    fft(new_aubio_fft(fftSize)),
+    frame(new_fvec(fftSize)),
+    spectrum(new_cvec(fftSize)),
+    taper(windowSize),
+    levels(fftSize / 2 + 1)
+{
+    // Блэкман-Харрис, 4 члена: боковые лепестки ниже -92 дБ не маскируют слабые партиалы
+    const double a0 = 0.35875, a1 = 0.48829, a2 = 0.14128, a3 = 0.01168;
+    for (int i = 0; i < windowSize; ++i) {
+        double phase = 2.0 * M_PI * i / (windowSize - 1);
+        taper[i] = float(a0 - a1 * std::cos(phase) + a2 * std::cos(2.0 * phase) - a3 * std::cos(3.0 * phase));
+    }
+}
+
+int InharmonicityAnalyzer::windowSizeFor(float sampleRate, float lowestFrequency)
+{
+    const float required = lowestFrequency > 0.0f ? RESOLVE_PERIODS * sampleRate / lowestFrequency : 0.0f;
+    int size = MIN_WINDOW;
+    while (size < MAX_WINDOW && size < required) size *= 2;
+    return size;
+}
+
+InharmonicityAnalyzer::~InharmonicityAnalyzer()
+{
+    if (fft) del_aubio_fft(fft);
+    if (frame) del_fvec(frame);
+    if (spectrum) del_cvec(spectrum);
+}
+
+bool InharmonicityAnalyzer::findPeak(int from, int to, float& frequency, float& levelDb) const
+{
+    from = std::max(from, 1);
+    to = std::min(to, int(levels.size()) - 2);
+    if (to - from < 2) return false;
+
+    int best = from;
+    for (int k = from + 1; k <= to; ++k) {
+        if (levels[k] > levels[best]) best = k;
+    }
+    if (best == from || best == to) return false;
+
+    // Парабола по трём бинам в дБ
+    const float left = levels[best - 1];
+    const float center = levels[best];
+    const float right = levels[best + 1];
+    const float denominator = left - 2.0f * center + right;
+    float offset = std::fabs(denominator) > 1e-9f ? 0.5f * (left - right) / denominator : 0.0f;
+    offset = std::clamp(offset, -0.5f, 0.5f);
+
+    frequency = (best + offset) * rate / fftSize;
+    levelDb = center - 0.25f * (left - right) * offset;
+    return true;
+}
+
+bool InharmonicityAnalyzer::fitModel(const PartialMeasurement* partials, int count, float& f0, float& b)
+{
+    // Линейная регрессия y = a + c x, x = n^2, y = (f_n / n)^2; f0^2 = a, B = c / a
+    if (count < 2) return false;
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    for (int i = 0; i < count; ++i) {
+        const double n = partials[i].number;
+        const double x = n * n;
+        const double y = std::pow(partials[i].frequency / n, 2.0);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    const double determinant = count * sxx - sx * sx;
+    if (std::fabs(determinant) < 1e-12) return false;
+
+    const double slope = (count * sxy - sx * sy) / determinant;
+    const double intercept = (sy - slope * sx) / count;
+    if (intercept <= 0.0) return false;
+
+    f0 = float(std::sqrt(intercept));
+    b = float(std::max(0.0, slope / intercept));
+    return true;
+}
+
+bool InharmonicityAnalyzer::analyze(const float* samples, float fundamentalHint, PartialsResult& result)
+{
+    result = PartialsResult();
+    if (fundamentalHint < lowestResolvable()) return false;
+
+    for (int i = 0; i < window; ++i) {
+        frame->data[i] = samples[i] * taper[i];
+    }
+    std::fill(frame->data + window, frame->data + fftSize, 0.0f);
+    aubio_fft_do(fft, frame, spectrum);
+
+    for (size_t k = 0; k < levels.size(); ++k) {
+        levels[k] = 20.0f * std::log10(spectrum->norm[k] + 1e-12f);
+    }
+
+    // Партиалы по очереди: оценка B уточняется по уже найденным,
+    // чтобы верхние партиалы не выпадали из полосы поиска
+    const float binHz = rate / fftSize;
+    const float nyquistLimit = 0.45f * rate;
+    float f0 = fundamentalHint;
+    float b = 0.0f;
+    float strongest = -1e9f;
+    PartialMeasurement found[PartialsResult::MAX_PARTIALS];
+    int count = 0;
+
+    for (int n = 1; n <= maxPartials; ++n) {
+        const float predicted = n * f0 * std::sqrt(1.0f + b * n * n);
+        if (predicted > nyquistLimit) break;
+
+        // Полоса не шире четверти расстояния до соседних партиалов
+        const float halfWidth = std::min(predicted * (std::exp2(SEARCH_CENTS / 1200.0f) - 1.0f), 0.25f * f0);
+        float frequency = 0.0f;
+        float level = 0.0f;
+        if (!findPeak(int(std::floor((predicted - halfWidth) / binHz)),
+                      int(std::ceil((predicted + halfWidth) / binHz)), frequency, level)) {
+            continue;
+        }
+
+        found[count].number = n;
+        found[count].frequency = frequency;
+        found[count].amplitudeDb = level;
+        strongest = std::max(strongest, level);
+        ++count;
+
+        if (count >= 3) {
+            fitModel(found, count, f0, b);
+        }
+    }
+
+    // Отбрасываем пики в шуме и пересчитываем модель по оставшимся
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        if (found[i].amplitudeDb < strongest - DYNAMIC_RANGE_DB) continue;
+        found[i].amplitudeDb -= strongest;
+        found[kept++] = found[i];
+    }
+    if (kept < 3 || !fitModel(found, kept, f0, b)) return false;
+
+    result.fundamental = f0;
+    result.inharmonicity = b;
+    result.count = kept;
+    for (int i = 0; i < kept; ++i) {
+        PartialMeasurement& partial = result.partials[i];
+        partial = found[i];
+        const float n = float(partial.number);
+        partial.harmonicCents = cents(partial.frequency / (n * f0));
+        partial.residualCents = cents(partial.frequency / (n * f0 * std::sqrt(1.0f + b * n * n)));
+    }
+    for (int n = 1; n <= PartialsResult::MAX_PARTIALS; ++n) {
+        result.stretchCents[n - 1] = 600.0f * std::log2((1.0f + b * n * n) / (1.0f + b));
+    }
+    return true;
+}
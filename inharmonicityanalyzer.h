@@ -0,0 +1,80 @@
+#ifndef INHARMONICITYANALYZER_H
+#define INHARMONICITYANALYZER_H
+
+#include <aubio/aubio.h>
+#include <vector>
+
+struct PartialMeasurement {
+    int number;            // Номер партиала, 1 — основной тон
+    float frequency;
+    float amplitudeDb;     // Относительно самого сильного партиала
+    float harmonicCents;   // Отклонение от n * f0 (f0 — по модели)
+    float residualCents;   // Отклонение от модели n * f0 * sqrt(1 + B n^2)
+};
+
+struct PartialsResult {
+    static const int MAX_PARTIALS = 16;
+
+    float fundamental = 0.0f;    // f0 идеальной (жёсткости нет) струны по модели
+    float inharmonicity = 0.0f;  // Коэффициент B
+    int count = 0;
+    PartialMeasurement partials[MAX_PARTIALS];
+    // Кривая растяжки: на сколько центов партиал n выше n-кратного первого
+    // партиала (индекс n - 1). Чтобы чистый унисон с партиалом n другой ноты
+    // совпал, цель настройки сдвигается на эту величину.
+    float stretchCents[MAX_PARTIALS] = {};
+
+    bool isValid() const { return count >= 3; }
+};
+
+// Анализ партиалов для настройки с растяжкой (фортепиано, бас).
+// Окно Блэкмана-Харриса, БПФ с дополнением нулями и параболической
+// интерполяцией пиков по логарифму амплитуды. Партиал n ищется около
+// n * f0 * sqrt(1 + B n^2) с текущей оценкой B, а B и f0 получаются
+// регрессией (f_n / n)^2 = f0^2 + f0^2 B n^2.
+class InharmonicityAnalyzer
+{
+public:
+    InharmonicityAnalyzer(float sampleRate, int windowSize = 8192, int padFactor = 4,
+                          int maxPartials = PartialsResult::MAX_PARTIALS);
+    ~InharmonicityAnalyzer();
+
+    // Главный лепесток Блэкмана-Харриса — ±4 бина, то есть ±4 * rate / windowSize.
+    // Соседние партиалы (шаг f0) разделяются, если лепесток целиком не шире шага:
+    // окно не короче RESOLVE_PERIODS периодов самой низкой ноты.
+    static const int RESOLVE_PERIODS = 8;
+    static const int MIN_WINDOW = 8192;
+    static const int MAX_WINDOW = 32768;
+
+    // Степень двойки для самой низкой ожидаемой ноты (нижняя граница профиля)
+    static int windowSizeFor(float sampleRate, float lowestFrequency);
+
+    // window — windowSize последних отсчётов; fundamentalHint — питч от детектора.
+    // Подсказка ниже lowestResolvable() отвергается: партиалы там сливаются.
+    // Возвращает result.isValid()
+    bool analyze(const float* window, float fundamentalHint, PartialsResult& result);
+
+    int windowSize() const { return window; }
+    float lowestResolvable() const { return RESOLVE_PERIODS * rate / window; }
+
+private:
+    InharmonicityAnalyzer(const InharmonicityAnalyzer&) = delete;
+    InharmonicityAnalyzer& operator=(const InharmonicityAnalyzer&) = delete;
+
+    // Пик в полосе бинов [from, to]; false, если максимум на краю полосы
+    bool findPeak(int from, int to, float& frequency, float& levelDb) const;
+    static bool fitModel(const PartialMeasurement* partials, int count, float& f0, float& b);
+
+    float rate;
+    int window;
+    int fftSize;
+    int maxPartials;
+
+    aubio_fft_t* fft;
+    fvec_t* frame;
+    cvec_t* spectrum;
+    std::vector<float> taper;
+    std::vector<float> levels;   // Спектр в дБ
+};
+
+#endif // INHARMONICITYANALYZER_H
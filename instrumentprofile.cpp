@@ -0,0 +1,43 @@
+#include "instrumentprofile.h"
+#include <algorithm>
+
+QList<InstrumentProfile> InstrumentProfile::builtIn()
+{
+    // Нижняя граница чуть ниже самой низкой ноты строя с запасом на перестройку
+    return {
+        { "guitar",  "Гитара",  70.0f,  1400.0f, 2048, 512, true },
+        { "bass",    "Бас",     30.0f,   400.0f, 4096, 512, true },
+        { "violin",  "Скрипка", 180.0f, 3500.0f, 1024, 256, true },
+        { "ukulele", "Укулеле", 180.0f, 1200.0f, 1024, 256, true },
+        { "voice",   "Голос",   75.0f,  1100.0f, 2048, 512, true },
+    };
+}
+
+InstrumentProfile InstrumentProfile::find(const QString& id)
+{
+    const QList<InstrumentProfile> profiles = builtIn();
+    for (const InstrumentProfile& profile : profiles) {
+        if (profile.id == id) return profile;
+    }
+    return profiles.first();
+}
+
+InstrumentProfile InstrumentProfile::custom(float minFrequency, float maxFrequency, float sampleRate)
+{
+    InstrumentProfile profile;
+    profile.id = "custom";
+    profile.name = "Свой";
+    profile.minFrequency = std::max(20.0f, minFrequency);
+    profile.maxFrequency = std::max(profile.minFrequency * 2.0f, maxFrequency);
+    profile.tracking = true;
+
+    // Половина окна — не меньше 1.2 периода нижней ноты, окно — степень двойки
+    const float halfWindow = 1.2f * sampleRate / profile.minFrequency;
+    int window = 512;
+    while (window / 2 < halfWindow && window < 8192) {
+        window *= 2;
+    }
+    profile.windowSize = window;
+    profile.hopSize = std::clamp(window / 4, 128, 512);
+    return profile;
+}
@@ -0,0 +1,28 @@
+#ifndef INSTRUMENTPROFILE_H
+#define INSTRUMENTPROFILE_H
+
+#include <QList>
+#include <QString>
+
+// Профиль инструмента: диапазон основного тона и параметры анализа.
+// Диапазон ограничивает поиск лагов YIN и состояния трекера, окно выбирается
+// так, чтобы в его половину помещалось не меньше периода самой низкой ноты.
+// Размеры окна и хопа — в отсчётах входного потока (48 кГц).
+struct InstrumentProfile
+{
+    QString id;
+    QString name;
+    float minFrequency;
+    float maxFrequency;
+    int windowSize;
+    int hopSize;
+    bool tracking;      // HMM-трекинг; false — одиночный кандидат aubio
+
+    static QList<InstrumentProfile> builtIn();
+    // Встроенный профиль по id; неизвестный id — гитара
+    static InstrumentProfile find(const QString& id);
+    // Произвольный диапазон; окно и хоп подбираются по нижней частоте
+    static InstrumentProfile custom(float minFrequency, float maxFrequency, float sampleRate = 48000.0f);
+};
+
+#endif // INSTRUMENTPROFILE_H
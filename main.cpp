@@ -1,12 +1,198 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QScopedPointer>
+#include <QTextStream>
+#include <cstring>
+#include "offlineanalyzer.h"
+
+// Проверка ключа до создания приложения: парсер требует готовый QCoreApplication,
+// а выбор между ним и QApplication нужен раньше (--name или --name=value)
+static bool hasOption(int argc, char *argv[], const char* name)
+{
+    const size_t length = std::strlen(name);
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--", 2) != 0) continue;
+        arg += 2;
+        if (std::strncmp(arg, name, length) == 0 && (arg[length] == '\0' || arg[length] == '=')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Анализ файла без окна: CSV "time,pitch_hz,confidence" в файл или stdout
+static int analyzeFile(const QString& path, const QString& outputPath, const OfflineAnalyzer::Settings& settings)
+{
+    QFile output;
+    if (outputPath.isEmpty()) {
+        output.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    } else {
+        output.setFileName(outputPath);
+        if (!output.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            qCritical() << "Cannot write" << outputPath;
+            return 1;
+        }
+    }
+
+    OfflineAnalyzer analyzer(settings);
+    analyzer.setProgressCallback([](int done, int total) {
+        qInfo().noquote() << QString("Segment %1/%2").arg(done).arg(total);
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    QVector<OfflinePitchFrame> frames;
+    QString error;
+    if (!analyzer.analyze(path, frames, error)) {
+        qCritical().noquote() << error;
+        return 1;
+    }
+
+    QTextStream stream(&output);
+    stream << "time,pitch_hz,confidence\n";
+    for (const OfflinePitchFrame& frame : frames) {
+        stream << QString::number(frame.time, 'f', 4) << ','
+               << QString::number(frame.pitchHz, 'f', 3) << ','
+               << QString::number(frame.confidence, 'f', 3) << '\n';
+    }
+    qInfo() << frames.size() << "hops analyzed in" << timer.elapsed() << "ms";
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
-    qApp->setWindowIcon(QIcon(":/image/music.png"));
+    // Анализ файла не открывает окон: без QApplication он работает на машинах
+    // без дисплея и не требует QT_QPA_PLATFORM=offscreen
+    const bool headless = hasOption(argc, argv, "analyze-file");
+    QScopedPointer<QCoreApplication> a(headless ? new QCoreApplication(argc, argv)
+                                                : new QApplication(argc, argv));
+    if (!headless) {
+        QApplication::setWindowIcon(QIcon(":/image/music.png"));
+    }
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption pitchStreamOption("pitch-stream",
+                                         "Publish detected pitch to shared memory for other local processes.");
+    parser.addOption(pitchStreamOption);
+    QCommandLineOption mainsOption("mains-frequency",
+                                   "Mains frequency to notch out before detection: 50, 60 or 0 to disable.",
+                                   "hz", "50");
+    parser.addOption(mainsOption);
+    QCommandLineOption noPreFilterOption("no-prefilter", "Disable the DC/high-pass/hum filter stage.");
+    parser.addOption(noPreFilterOption);
+    QCommandLineOption noTrackingOption("no-tracking", "Use the single aubio candidate instead of HMM pitch tracking.");
+    parser.addOption(noTrackingOption);
+    QCommandLineOption decimateOption("decimate", "Analyze at a reduced sample rate chosen from the instrument range.");
+    parser.addOption(decimateOption);
+    QCommandLineOption profileOption("profile",
+                                     "Instrument profile: guitar, bass, violin, ukulele or voice.",
+                                     "name", "guitar");
+    parser.addOption(profileOption);
+    QCommandLineOption minFrequencyOption("min-frequency", "Lowest fundamental of the instrument, Hz (custom profile).", "hz");
+    parser.addOption(minFrequencyOption);
+    QCommandLineOption maxFrequencyOption("max-frequency", "Highest fundamental of the instrument, Hz (custom profile).", "hz");
+    parser.addOption(maxFrequencyOption);
+    QCommandLineOption graphOption("graph-threads",
+                                   "Run analysis as a pipelined stage graph on N threads (0 = one per core).",
+                                   "n");
+    parser.addOption(graphOption);
+    QCommandLineOption contourOption("contour-hop",
+                                     "Also estimate a dense pitch contour every N samples (must divide the profile hop).",
+                                     "n");
+    parser.addOption(contourOption);
+    QCommandLineOption noIdleOption("no-idle", "Keep full-rate analysis during silence instead of the idle mode.");
+    parser.addOption(noIdleOption);
+    QCommandLineOption idleLevelOption("idle-level",
+                                       "Signal level below which the tuner goes idle after 2 s, dBFS.",
+                                       "db", "-60");
+    parser.addOption(idleLevelOption);
+    QCommandLineOption realtimeOption("realtime-priority",
+                                      "Run analysis threads with SCHED_FIFO (or SCHED_RR) at this priority, 1-99.",
+                                      "priority");
+    parser.addOption(realtimeOption);
+    QCommandLineOption affinityOption("cpu-affinity", "Pin analysis threads to these CPUs, e.g. 2,3 or 2-3.", "cpus");
+    parser.addOption(affinityOption);
+    QCommandLineOption lockMemoryOption("lock-memory", "Lock process memory (mlockall) and pre-fault thread stacks.");
+    parser.addOption(lockMemoryOption);
+    QCommandLineOption analyzeOption("analyze-file",
+                                     "Analyze a recording on all cores, write CSV and exit (no window).",
+                                     "path");
+    parser.addOption(analyzeOption);
+    QCommandLineOption outputOption("output", "CSV file for --analyze-file (default: stdout).", "path");
+    parser.addOption(outputOption);
+    QCommandLineOption analyzeThreadsOption("analyze-threads", "Threads for --analyze-file (0 = one per core).",
+                                            "n", "0");
+    parser.addOption(analyzeThreadsOption);
+    QCommandLineOption driftLogOption("drift-log",
+                                      "Append per-string cents statistics to this CSV every interval (rotated at 8 MB).",
+                                      "path");
+    parser.addOption(driftLogOption);
+    QCommandLineOption driftIntervalOption("drift-interval", "Drift log interval, seconds.", "s", "10");
+    parser.addOption(driftIntervalOption);
+    parser.process(*a);
+
+    PreFilter::Settings preFilter;
+    preFilter.enabled = !parser.isSet(noPreFilterOption);
+    preFilter.mainsFrequency = parser.value(mainsOption).toFloat();
+
+    // Явный диапазон частот превращает выбранный профиль в свой
+    InstrumentProfile profile = InstrumentProfile::find(parser.value(profileOption));
+    if (parser.isSet(minFrequencyOption) || parser.isSet(maxFrequencyOption)) {
+        float minFrequency = parser.isSet(minFrequencyOption) ? parser.value(minFrequencyOption).toFloat()
+                                                              : profile.minFrequency;
+        float maxFrequency = parser.isSet(maxFrequencyOption) ? parser.value(maxFrequencyOption).toFloat()
+                                                              : profile.maxFrequency;
+        profile = InstrumentProfile::custom(minFrequency, maxFrequency);
+    }
+
+    if (parser.isSet(analyzeOption)) {
+        OfflineAnalyzer::Settings offline;
+        offline.profile = profile;
+        offline.preFilter = preFilter;
+        offline.decimate = parser.isSet(decimateOption);
+        offline.threads = parser.value(analyzeThreadsOption).toInt();
+        return analyzeFile(parser.value(analyzeOption), parser.value(outputOption), offline);
+    }
+
     MainWindow w;
+    w.recorder()->setPitchStreamEnabled(parser.isSet(pitchStreamOption));
+    w.recorder()->setPreFilterSettings(preFilter);
+    w.recorder()->setTrackingEnabled(!parser.isSet(noTrackingOption));
+    w.recorder()->setDecimationEnabled(parser.isSet(decimateOption));
+    w.setInstrumentProfile(profile);
+    if (parser.isSet(graphOption)) {
+        w.recorder()->setProcessingGraphEnabled(true, parser.value(graphOption).toInt());
+    }
+    if (parser.isSet(contourOption)) {
+        w.recorder()->setContourHop(parser.value(contourOption).toInt());
+    }
+    IdleMonitor::Settings idle;
+    idle.enabled = !parser.isSet(noIdleOption);
+    idle.enterLevelDb = parser.value(idleLevelOption).toFloat();
+    idle.exitLevelDb = idle.enterLevelDb + 6.0f;
+    w.recorder()->setIdleSettings(idle);
+
+    RealtimeSupport::Settings realtime;
+    realtime.realtime = parser.isSet(realtimeOption);
+    if (realtime.realtime) {
+        realtime.priority = parser.value(realtimeOption).toInt();
+    }
+    realtime.cpus = RealtimeSupport::parseCpuList(parser.value(affinityOption));
+    realtime.lockMemory = parser.isSet(lockMemoryOption);
+    w.recorder()->setRealtimeSettings(realtime);
+
+    if (parser.isSet(driftLogOption)
+        && !w.statistics()->startLog(parser.value(driftLogOption), parser.value(driftIntervalOption).toInt())) {
+        qCritical() << "Cannot write drift log" << parser.value(driftLogOption);
+        return 1;
+    }
     w.show();
-    return a.exec();
+    return a->exec();
 }
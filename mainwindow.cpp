@@ -2,6 +2,7 @@
 #include "./ui_mainwindow.h"
 #include <QMessageBox>
 #include <QPushButton>
+#include <QComboBox>
 #include <QLabel>
 #include <QScrollArea>
 
@@ -12,10 +13,15 @@ MainWindow::MainWindow(QWidget *parent)
     , currentTargetString("")
     , currentTargetFrequency(0.0f)
     , manualStringSelection(false)
+    , lastNoteFrequency(0.0f)
+    , customProfile(InstrumentProfile::custom(50.0f, 1500.0f))
+    , partialsLabel(nullptr)
 {
     ui->setupUi(this);
 
     audioRecorder = new QtAudioRecorder(this);
+    tuningStatistics = new TuningStatistics(this);
+    toneGenerator = new ToneGenerator(this);
 
     // Подключаем сигнал о обнаруженной высоте тона
     connect(audioRecorder, &QtAudioRecorder::pitchDetected,
@@ -24,6 +30,33 @@ MainWindow::MainWindow(QWidget *parent)
     connect(audioRecorder, &QtAudioRecorder::errorOccurred,
             this, &MainWindow::handleAudioError);
 
+    connect(audioRecorder, &QtAudioRecorder::deviceReady, this, [this](const QString& description) {
+        ui->statusbar->showMessage(QString("Микрофон: %1").arg(description), 3000);
+    });
+
+    connect(audioRecorder, &QtAudioRecorder::deviceSwitched, this, [this](const QString& description, qint64 downtimeMs) {
+        ui->statusbar->showMessage(QString("Микрофон: %1 (перерыв %2 мс)").arg(description).arg(downtimeMs), 5000);
+    });
+
+    connect(audioRecorder, &QtAudioRecorder::deviceLost, this, [this]() {
+        ui->statusbar->showMessage("Микрофон отключён, ожидание подключения...");
+    });
+
+    connect(audioRecorder, &QtAudioRecorder::realtimeStatus, this, [this](const QString& message) {
+        ui->statusbar->showMessage(message, 8000);
+    });
+
+    // В простое обновлений нет, поэтому индикатор сбрасываем сразу
+    connect(audioRecorder, &QtAudioRecorder::idleStateChanged, this, [this](bool idle) {
+        if (!recordingActive) return;
+        if (idle) {
+            showNoSignal();
+            ui->statusbar->showMessage("Ожидание сигнала (экономичный режим)");
+        } else {
+            ui->statusbar->showMessage("Прослушивание...", 2000);
+        }
+    });
+
     // Подключаем кнопки струн
     connect(ui->e2Button, &QPushButton::clicked, this, &MainWindow::onE2ButtonClicked);
     connect(ui->aButton, &QPushButton::clicked, this, &MainWindow::onAButtonClicked);
@@ -34,12 +67,42 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(ui->helpButton, &QPushButton::clicked, this, &MainWindow::showHelpDialog);
 
+    connect(ui->actionPartials, &QAction::toggled, this, &MainWindow::setPartialsViewVisible);
+    connect(audioRecorder, &QtAudioRecorder::partialsAnalyzed, this, &MainWindow::showPartials);
+
+    // Опорный тон играет независимо от записи (вывод и захват работают одновременно)
+    connect(ui->toneButton, &QPushButton::toggled, this, &MainWindow::setReferenceToneEnabled);
+    connect(toneGenerator, &ToneGenerator::errorOccurred, this, [this](const QString& message) {
+        ui->toneButton->setChecked(false);
+        ui->statusbar->showMessage(message, 5000);
+    });
+
+    connect(ui->actionStatistics, &QAction::triggered, this, &MainWindow::showStatistics);
+    connect(ui->actionNoiseCalibration, &QAction::triggered, this, &MainWindow::calibrateNoise);
+    connect(ui->actionClearNoise, &QAction::triggered, this, [this]() {
+        audioRecorder->clearNoiseProfile();
+        ui->statusbar->showMessage("Профиль шума сброшен", 3000);
+    });
+    connect(audioRecorder, &QtAudioRecorder::noiseCalibrationFinished, this, [this](bool success) {
+        ui->statusbar->showMessage(success ? "Профиль шума сохранён, шум вычитается перед анализом"
+                                           : "Не удалось записать профиль шума", 5000);
+    });
+
+    // Профили инструментов; последний пункт — свой диапазон (задаётся из командной строки)
+    for (const InstrumentProfile& profile : InstrumentProfile::builtIn()) {
+        ui->profileComboBox->addItem(profile.name, profile.id);
+    }
+    ui->profileComboBox->addItem(customProfile.name, customProfile.id);
+    ui->profileComboBox->setCurrentIndex(ui->profileComboBox->findData(audioRecorder->instrumentProfile().id));
+    connect(ui->profileComboBox, &QComboBox::currentIndexChanged, this, &MainWindow::onProfileSelected);
+
     connect(ui->autoButton, &QPushButton::clicked, this, [this]() {
         manualStringSelection = false;
         currentTargetString = "";
         currentTargetFrequency = 0.0f;
         updateTargetIndicator();
         resetStringHighlights();
+        if (toneGenerator->isPlaying()) toneGenerator->play(referenceFrequency());
         ui->statusbar->showMessage("Auto detection enabled", 2000);
     });
 
@@ -52,6 +115,10 @@ MainWindow::MainWindow(QWidget *parent)
     targetIndicator->setObjectName("targetIndicator");
     targetIndicator->setStyleSheet("color: #4facfe; font-weight: bold;");
     ui->statusbar->addPermanentWidget(targetIndicator);
+
+    // Поиск микрофона — из цикла событий, когда окно уже создано
+    ui->statusbar->showMessage("Поиск микрофона...");
+    QTimer::singleShot(0, audioRecorder, &QtAudioRecorder::initialize);
 }
 
 MainWindow::~MainWindow()
@@ -72,6 +139,7 @@ void MainWindow::setTargetString(const QString& stringName, float frequency)
 
     // Обновляем UI
     updateTargetIndicator();
+    if (toneGenerator->isPlaying()) toneGenerator->play(frequency);
 
     // Сбрасываем выделение всех кнопок
     resetStringHighlights();
@@ -206,6 +274,176 @@ void MainWindow::resetDisplay()
 }
 
 
+void MainWindow::setInstrumentProfile(const InstrumentProfile& profile)
+{
+    if (profile.id == customProfile.id) {
+        customProfile = profile;
+    }
+    int index = ui->profileComboBox->findData(profile.id);
+    if (index == ui->profileComboBox->currentIndex()) {
+        onProfileSelected(index);
+    } else {
+        ui->profileComboBox->setCurrentIndex(index);
+    }
+}
+
+void MainWindow::onProfileSelected(int index)
+{
+    QString id = ui->profileComboBox->itemData(index).toString();
+    InstrumentProfile profile = id == customProfile.id ? customProfile : InstrumentProfile::find(id);
+    audioRecorder->setInstrumentProfile(profile);
+
+    // Кнопки струн — гитарный строй, для других инструментов остаётся автопоиск
+    const bool guitar = profile.id == "guitar";
+    for (QPushButton* button : { ui->e2Button, ui->aButton, ui->dButton,
+                                ui->gButton, ui->bButton, ui->e4Button }) {
+        button->setEnabled(guitar);
+    }
+    if (!guitar && manualStringSelection) {
+        manualStringSelection = false;
+        currentTargetString = "";
+        currentTargetFrequency = 0.0f;
+        updateTargetIndicator();
+        resetStringHighlights();
+    }
+
+    ui->statusbar->showMessage(QString("Инструмент: %1 (%2–%3 Гц)")
+                                   .arg(profile.name)
+                                   .arg(profile.minFrequency, 0, 'f', 0)
+                                   .arg(profile.maxFrequency, 0, 'f', 0), 3000);
+}
+
+void MainWindow::calibrateNoise()
+{
+    if (!recordingActive) {
+        QMessageBox::information(this, "Шум", "Запустите тюнер, затем 2 секунды ничего не играйте.");
+        return;
+    }
+    showNoSignal();
+    ui->statusbar->showMessage("Запись фонового шума: 2 секунды ничего не играйте...");
+    audioRecorder->calibrateNoise(2.0f);
+}
+
+void MainWindow::setPartialsViewVisible(bool visible)
+{
+    audioRecorder->setPartialsAnalysisEnabled(visible);
+
+    if (!visible) {
+        if (partialsDialog) partialsDialog->close();
+        return;
+    }
+    if (partialsDialog) return;
+
+    partialsDialog = new QDialog(this);
+    partialsDialog->setWindowTitle("Партиалы и негармоничность");
+    partialsDialog->resize(420, 480);
+    partialsDialog->setModal(false);
+    partialsDialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    QVBoxLayout *layout = new QVBoxLayout(partialsDialog);
+    layout->setContentsMargins(20, 20, 20, 20);
+    partialsLabel = new QLabel("Сыграйте ноту и дайте ей прозвучать...", partialsDialog);
+    partialsLabel->setTextFormat(Qt::RichText);
+    partialsLabel->setAlignment(Qt::AlignTop | Qt::AlignLeft);
+    layout->addWidget(partialsLabel);
+
+    // Закрытие окна выключает анализ
+    connect(partialsDialog, &QDialog::finished, this, [this]() {
+        partialsLabel = nullptr;
+        ui->actionPartials->setChecked(false);
+    });
+
+    partialsDialog->show();
+}
+
+void MainWindow::showPartials(const PartialsResult& result)
+{
+    if (!partialsLabel) return;
+
+    QString text = QString("<b>f₀</b>: %1 Гц &nbsp; <b>B</b>: %2<br><br>"
+                           "<table cellspacing='4'>"
+                           "<tr><th>n</th><th>Гц</th><th>дБ</th><th>от n·f₀, ц</th><th>растяжка, ц</th></tr>")
+                       .arg(result.fundamental, 0, 'f', 2)
+                       .arg(result.inharmonicity, 0, 'e', 2);
+    for (int i = 0; i < result.count; ++i) {
+        const PartialMeasurement& partial = result.partials[i];
+        text += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td></tr>")
+                    .arg(partial.number)
+                    .arg(partial.frequency, 0, 'f', 2)
+                    .arg(partial.amplitudeDb, 0, 'f', 0)
+                    .arg(partial.harmonicCents, 0, 'f', 1)
+                    .arg(result.stretchCents[partial.number - 1], 0, 'f', 1);
+    }
+    text += "</table>";
+    partialsLabel->setText(text);
+}
+
+float MainWindow::referenceFrequency() const
+{
+    if (manualStringSelection && currentTargetFrequency > 0) return currentTargetFrequency;
+    return lastNoteFrequency > 0 ? lastNoteFrequency : 440.0f;
+}
+
+void MainWindow::setReferenceToneEnabled(bool enabled)
+{
+    if (enabled) {
+        toneGenerator->play(referenceFrequency());
+        ui->statusbar->showMessage(QString("Опорный тон %1 Гц").arg(toneGenerator->frequency(), 0, 'f', 2), 3000);
+    } else {
+        toneGenerator->stop();
+        toneStopped.start();
+    }
+}
+
+bool MainWindow::isToneAudible() const
+{
+    // После выключения тон ещё доигрывает буфер и затухает в помещении
+    return toneGenerator->isPlaying() || (toneStopped.isValid() && toneStopped.elapsed() < TONE_RELEASE_MS);
+}
+
+void MainWindow::showStatistics()
+{
+    const QMap<QString, TuningStatistics::StringStatistics>& strings = tuningStatistics->strings();
+    if (strings.isEmpty()) {
+        QMessageBox::information(this, "Статистика", "Показаний пока нет.");
+        return;
+    }
+
+    QString text = "<table cellspacing='4'>"
+                   "<tr><th>Струна</th><th>N</th><th>среднее, ц</th><th>σ, ц</th>"
+                   "<th>5 %</th><th>50 %</th><th>95 %</th><th>вне ±50 ц</th></tr>";
+    for (auto it = strings.begin(); it != strings.end(); ++it) {
+        const RunningStatistics& total = it.value().total;
+        text += QString("<tr><td>%1</td><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td><td>%7</td><td>%8</td></tr>")
+                    .arg(it.key())
+                    .arg(total.count())
+                    .arg(total.mean(), 0, 'f', 2)
+                    .arg(total.standardDeviation(), 0, 'f', 2)
+                    .arg(total.percentile5(), 0, 'f', 1)
+                    .arg(total.median(), 0, 'f', 1)
+                    .arg(total.percentile95(), 0, 'f', 1)
+                    .arg(it.value().rejected);
+    }
+    text += "</table>";
+    QMessageBox::information(this, "Статистика", text);
+}
+
+void MainWindow::recordReading(float pitchHz)
+{
+    if (pitchHz <= 0.0f) return;
+
+    // Ключ — имя ноты и в ручном режиме: иначе струна A копится то как "A", то как "A2"
+    if (manualStringSelection && currentTargetFrequency > 0) {
+        tuningStatistics->addReading(NoteConverter::frequencyToNoteName(currentTargetFrequency),
+                                     1200.0f * std::log2(pitchHz / currentTargetFrequency));
+    } else {
+        QString noteName;
+        float targetFreq;
+        float cents = NoteConverter::frequencyToCents(pitchHz, noteName, targetFreq);
+        tuningStatistics->addReading(noteName, cents);
+    }
+}
+
 void MainWindow::onE2ButtonClicked()
 {
     setTargetString("E2", 82.41f);
@@ -239,7 +477,13 @@ void MainWindow::onE4ButtonClicked()
 
 void MainWindow::updateTunerDisplay(float pitchHz)
 {
-    if (!recordingActive) return;
+    // Во время записи шума детектор видит только шум
+    if (!recordingActive || audioRecorder->isCalibratingNoise()) return;
+
+    // Статистика — по сырому показанию, сглаживание только для экрана.
+    // Пока звучит опорный тон, микрофон слышит его, а не инструмент.
+    const bool toneAudible = isToneAudible();
+    if (!toneAudible) recordReading(pitchHz);
 
     float smoothedHz = applyAdaptiveSmoothing(pitchHz);
 
@@ -278,6 +522,7 @@ void MainWindow::updateTunerDisplay(float pitchHz)
             QString noteName;
             float targetFreq;
             float cents = NoteConverter::frequencyToCents(smoothedHz, noteName, targetFreq);
+            if (!toneAudible) lastNoteFrequency = targetFreq;
 
             ui->noteLabel->setText(noteName);
             ui->centsLabel->setText(QString("Центы: %1").arg(qRound(cents)));
@@ -304,17 +549,22 @@ void MainWindow::updateTunerDisplay(float pitchHz)
         }
 
     } else {
-        // Нет сигнала
-        ui->frequencyLabel->setText("--- Гц");
-        ui->noteLabel->setText("---");
-        ui->centsLabel->setText("Центы: ---");
-        ui->tuningBar->setValue(0);
-        ui->tuningBar->setStyleSheet("QProgressBar::chunk { background-color: #555555; }");
-        ui->centsLabel->setStyleSheet("color: #a0aec0; background: transparent;");
-
-        if (!manualStringSelection) {
-            resetStringHighlights();
-        }
+        showNoSignal();
+    }
+}
+
+void MainWindow::showNoSignal()
+{
+    // Нет сигнала; выбранная вручную струна сохраняется
+    ui->frequencyLabel->setText("--- Гц");
+    ui->noteLabel->setText("---");
+    ui->centsLabel->setText("Центы: ---");
+    ui->tuningBar->setValue(0);
+    ui->tuningBar->setStyleSheet("QProgressBar::chunk { background-color: #555555; }");
+    ui->centsLabel->setStyleSheet("color: #a0aec0; background: transparent;");
+
+    if (!manualStringSelection) {
+        resetStringHighlights();
     }
 }
 
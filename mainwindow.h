@@ -6,7 +6,14 @@
 #include <QMap>
 #include "qtaudiorecorder.h"
 #include "NoteConverter.h"
+#include "tonegenerator.h"
+#include "tuningstatistics.h"
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QPointer>
+
+class QDialog;
+class QLabel;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -20,6 +27,13 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    QtAudioRecorder *recorder() const { return audioRecorder; }
+    // Статистика отклонений по струнам и журнал дрейфа
+    TuningStatistics *statistics() const { return tuningStatistics; }
+
+    // Выбирает профиль инструмента в списке и передаёт его записи
+    void setInstrumentProfile(const InstrumentProfile& profile);
+
 private slots:
     void on_startStopButton_clicked();
     void updateTunerDisplay(float pitchHz);
@@ -33,22 +47,42 @@ private slots:
     void onBButtonClicked();
     void onE4ButtonClicked();
     void showHelpDialog();
+    void onProfileSelected(int index);
+    void setPartialsViewVisible(bool visible);
+    void showPartials(const PartialsResult& result);
+    void calibrateNoise();
+    void showStatistics();
+    void setReferenceToneEnabled(bool enabled);
 
 private:
     Ui::MainWindow *ui;
     QtAudioRecorder *audioRecorder;
+    TuningStatistics *tuningStatistics;
+    ToneGenerator *toneGenerator;
     bool recordingActive;
 
     QString currentTargetString;
     float currentTargetFrequency;
     bool manualStringSelection;
+    float lastNoteFrequency;  // Ближайшая нота последнего показания (автопоиск)
+    QElapsedTimer toneStopped;
+    static const int TONE_RELEASE_MS = 300;
+    InstrumentProfile customProfile;
+
+    // Окно анализа партиалов (создаётся при включении)
+    QPointer<QDialog> partialsDialog;
+    QLabel *partialsLabel;
 
     // Методы для работы с целевыми струнами
     void setTargetString(const QString& stringName, float frequency);
     void highlightCorrectString(float pitchHz);
     void resetStringHighlights();
     void resetDisplay();
+    void showNoSignal();
     void updateTargetIndicator();
+    void recordReading(float pitchHz);
+    float referenceFrequency() const;
+    bool isToneAudible() const;
 
     // Частоты стандартных гитарных струн
     const QMap<QString, float> stringFrequencies = {
@@ -0,0 +1,128 @@
+#include "multichanneldetector.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+size_t floatStride(size_t count)
+{
+    return alignUp(count * sizeof(float), MultiChannelPitchDetector::CACHE_LINE) / sizeof(float);
+}
+
+struct ArenaLayout {
+    size_t historyStride;
+    size_t scratchStride;
+    size_t historyOffset;
+    size_t scratchOffset;
+    size_t statesOffset;
+    size_t total;
+};
+
+ArenaLayout layoutFor(int channels, int windowSize)
+{
+    const size_t line = MultiChannelPitchDetector::CACHE_LINE;
+    ArenaLayout layout;
+    layout.historyStride = floatStride(2 * size_t(windowSize));
+    layout.scratchStride = floatStride(size_t(windowSize) / 2 + 1);
+
+    size_t offset = 0;
+    layout.historyOffset = offset;
+    offset += alignUp(channels * layout.historyStride * sizeof(float), line);
+    layout.scratchOffset = offset;
+    offset += alignUp(channels * layout.scratchStride * sizeof(float), line);
+    layout.statesOffset = offset;
+    offset += channels * line; // ChannelState — ровно одна кэш-линия
+    layout.total = offset;
+    return layout;
+}
+}
+
+MultiChannelPitchDetector::MultiChannelPitchDetector(int channelCount, float sampleRate, int windowSize, int hopSize)
+    : channels(channelCount),
+    windowLength(windowSize),
+    hop(hopSize),
+    kernel(windowSize, sampleRate)
+{
+    const ArenaLayout layout = layoutFor(channels, windowLength);
+    historyStride = layout.historyStride;
+    scratchStride = layout.scratchStride;
+    arenaSize = layout.total;
+
+    arena = static_cast<unsigned char*>(::operator new(arenaSize, std::align_val_t(CACHE_LINE)));
+    history = reinterpret_cast<float*>(arena + layout.historyOffset);
+    scratch = reinterpret_cast<float*>(arena + layout.scratchOffset);
+    states = reinterpret_cast<ChannelState*>(arena + layout.statesOffset);
+
+    reset();
+}
+
+MultiChannelPitchDetector::~MultiChannelPitchDetector()
+{
+    ::operator delete(arena, std::align_val_t(CACHE_LINE));
+}
+
+size_t MultiChannelPitchDetector::arenaBytesFor(int channels, int windowSize)
+{
+    return layoutFor(channels, windowSize).total;
+}
+
+void MultiChannelPitchDetector::reset()
+{
+    // Заодно касаемся каждой страницы арены, чтобы не ловить page fault на первом хопе
+    std::memset(arena, 0, arenaSize);
+}
+
+const float* MultiChannelPitchDetector::window(int channel) const
+{
+    return history + channel * historyStride + state(channel).writePosition;
+}
+
+void MultiChannelPitchDetector::pushHop(int channel, const float* samples)
+{
+    // Каждый отсчёт пишется дважды (в p и p + window), поэтому окно,
+    // начинающееся с позиции записи, всегда лежит в памяти подряд
+    float* row = history + channel * historyStride;
+    int position = state(channel).writePosition;
+    for (int i = 0; i < hop; ++i) {
+        row[position] = samples[i];
+        row[position + windowLength] = samples[i];
+        if (++position == windowLength) position = 0;
+    }
+    state(channel).writePosition = position;
+}
+
+float MultiChannelPitchDetector::process(int channel, const float* samples)
+{
+    pushHop(channel, samples);
+
+    PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+    const int count = kernel.analyze(window(channel), scratch + channel * scratchStride,
+                                     candidates, YinKernel::MAX_CANDIDATES);
+
+    // Без трекера берём наиболее вероятного кандидата
+    float best = 0.0f;
+    float bestProbability = 0.0f;
+    for (int i = 0; i < count; ++i) {
+        if (candidates[i].probability > bestProbability) {
+            bestProbability = candidates[i].probability;
+            best = candidates[i].frequency;
+        }
+    }
+
+    ChannelState& channelState = state(channel);
+    channelState.pitch = best;
+    channelState.confidence = bestProbability;
+    return best;
+}
+
+void MultiChannelPitchDetector::processAll(const float* const* hops)
+{
+    for (int channel = 0; channel < channels; ++channel) {
+        process(channel, hops[channel]);
+    }
+}
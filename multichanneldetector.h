@@ -0,0 +1,73 @@
+#ifndef MULTICHANNELDETECTOR_H
+#define MULTICHANNELDETECTOR_H
+
+#include <cstddef>
+#include "yinkernel.h"
+
+// Детектор питча для многих одновременных каналов.
+// Всё состояние каналов лежит в одной арене, выделенной один раз при создании,
+// в виде структуры массивов: отдельные блоки для истории, рабочих буферов
+// и скалярных полей, каждая строка выровнена на кэш-линию. Скаляры канала
+// занимают свою кэш-линию, чтобы потоки разных каналов не делили строки
+// (false sharing). Память растёт линейно с числом каналов, в процессе
+// работы ничего не выделяется.
+class MultiChannelPitchDetector
+{
+public:
+    static const size_t CACHE_LINE = 64;
+
+    MultiChannelPitchDetector(int channels, float sampleRate, int windowSize, int hopSize);
+    ~MultiChannelPitchDetector();
+
+    MultiChannelPitchDetector(const MultiChannelPitchDetector&) = delete;
+    MultiChannelPitchDetector& operator=(const MultiChannelPitchDetector&) = delete;
+
+    void reset();
+
+    // Обрабатывает hopSize отсчётов канала, возвращает питч в Гц (0 — нет сигнала).
+    // Разные каналы можно обрабатывать из разных потоков одновременно.
+    float process(int channel, const float* hop);
+    // hops[channel] — очередной хоп каждого канала
+    void processAll(const float* const* hops);
+
+    float pitch(int channel) const { return state(channel).pitch; }
+    float confidence(int channel) const { return state(channel).confidence; }
+
+    int channelCount() const { return channels; }
+    int hopSize() const { return hop; }
+    size_t arenaBytes() const { return arenaSize; }
+    static size_t arenaBytesFor(int channels, int windowSize);
+
+protected:
+    // Скалярное состояние канала, по кэш-линии на канал
+    struct alignas(CACHE_LINE) ChannelState {
+        int writePosition;
+        float pitch;
+        float confidence;
+    };
+    static_assert(sizeof(ChannelState) == CACHE_LINE, "one cache line per channel");
+
+    ChannelState& state(int channel) { return states[channel]; }
+    const ChannelState& state(int channel) const { return states[channel]; }
+
+    // Окно канала: windowSize отсчётов подряд, от старых к новым
+    const float* window(int channel) const;
+    void pushHop(int channel, const float* hop);
+
+    int channels;
+    int windowLength;
+    int hop;
+    YinKernel kernel;
+
+    // Шаг строк (в отсчётах), кратный кэш-линии
+    size_t historyStride;
+    size_t scratchStride;
+
+    unsigned char* arena;
+    size_t arenaSize;
+    float* history;      // [channel][2 * window] — зеркальное кольцо
+    float* scratch;      // [channel][scratchStride]
+    ChannelState* states; // [channel]
+};
+
+#endif // MULTICHANNELDETECTOR_H
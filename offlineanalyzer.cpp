@@ -0,0 +1,164 @@
+#include "offlineanalyzer.h"
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrent>
+#include <aubio/aubio.h>
+#include <algorithm>
+#include <memory>
+
+OfflineAnalyzer::OfflineAnalyzer(const Settings& settings)
+    : settings(settings)
+{
+}
+
+PitchDetector* OfflineAnalyzer::createDetector(float sampleRate) const
+{
+    const InstrumentProfile& profile = settings.profile;
+    PitchDetector* detector = new PitchDetector(sampleRate, profile.windowSize, profile.hopSize);
+    detector->setPreFilterSettings(settings.preFilter);
+    detector->setFrequencyRange(profile.minFrequency, profile.maxFrequency);
+    // Кандидаты для трекера есть только у YIN
+    detector->setTrackingEnabled(true);
+    if (settings.decimate) {
+        detector->setDecimationFactor(PolyphaseDecimator::factorForRange(sampleRate, profile.maxFrequency,
+                                                                         profile.hopSize));
+    }
+    return detector;
+}
+
+OfflineAnalyzer::SegmentResult OfflineAnalyzer::analyzeSegment(const QString& path, float sampleRate,
+                                                               long long firstHop, long long startHop,
+                                                               long long endHop,
+                                                               const PitchDetector::FilterState& state) const
+{
+    SegmentResult result;
+    const int hop = settings.profile.hopSize;
+
+    aubio_source_t* source = new_aubio_source(path.toLocal8Bit().constData(), uint_t(sampleRate), hop);
+    if (!source) {
+        result.error = QString("Cannot open %1").arg(path);
+        return result;
+    }
+    if (aubio_source_seek(source, uint_t(firstHop * hop)) != 0) {
+        result.error = QString("Cannot seek in %1").arg(path);
+        del_aubio_source(source);
+        return result;
+    }
+
+    std::unique_ptr<PitchDetector> detector(createDetector(sampleRate));
+    detector->restoreFilterState(state);
+
+    fvec_t* buffer = new_fvec(hop);
+    PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+    result.counts.reserve(size_t(endHop - startHop));
+
+    // Хопы до startHop только заполняют окно YIN
+    for (long long h = firstHop; h < endHop; ++h) {
+        uint_t read = 0;
+        aubio_source_do(source, buffer, &read);
+        if (read == 0) break;
+        std::fill(buffer->data + read, buffer->data + hop, 0.0f);
+
+        int count = detector->analyzeCandidates(buffer->data, candidates);
+        if (h >= startHop) {
+            result.counts.push_back((unsigned char)count);
+            result.candidates.insert(result.candidates.end(), candidates, candidates + count);
+        }
+        if (read < uint_t(hop)) break;
+    }
+
+    del_fvec(buffer);
+    del_aubio_source(source);
+    return result;
+}
+
+bool OfflineAnalyzer::analyze(const QString& path, QVector<OfflinePitchFrame>& frames, QString& error)
+{
+    frames.clear();
+    const int hop = settings.profile.hopSize;
+
+    aubio_source_t* source = new_aubio_source(path.toLocal8Bit().constData(), 0, hop);
+    if (!source) {
+        error = QString("Cannot open %1").arg(path);
+        return false;
+    }
+    const float sampleRate = float(aubio_source_get_samplerate(source));
+    const long long duration = aubio_source_get_duration(source);
+
+    const long long segmentHops = std::max(1LL, (long long)(settings.segmentSeconds * sampleRate / hop));
+    // Окно YIN целиком из отсчётов этого сегмента и предыдущих хопов
+    const long long warmupHops = (settings.profile.windowSize + hop - 1) / hop;
+    const int expectedSegments = duration > 0 ? int((duration / hop + segmentHops) / segmentHops) : 0;
+
+    QThreadPool pool;
+    if (settings.threads > 0) pool.setMaxThreadCount(settings.threads);
+
+    // Быстрый проход по фильтрам: состояние в начале каждого сегмента
+    std::unique_ptr<PitchDetector> filters(createDetector(sampleRate));
+    fvec_t* buffer = new_fvec(hop);
+    QList<QFuture<SegmentResult>> segments;
+    long long hopIndex = 0;
+    long long nextStart = 0;
+
+    while (true) {
+        // При коротких сегментах несколько из них могут начинаться с одного хопа
+        while (hopIndex == std::max(0LL, nextStart - warmupHops)) {
+            const long long firstHop = hopIndex;
+            const long long startHop = nextStart;
+            const long long endHop = nextStart + segmentHops;
+            PitchDetector::FilterState state = filters->filterState();
+            segments << QtConcurrent::run(&pool, [this, path, sampleRate, firstHop, startHop, endHop, state]() {
+                return analyzeSegment(path, sampleRate, firstHop, startHop, endHop, state);
+            });
+            nextStart += segmentHops;
+        }
+
+        uint_t read = 0;
+        aubio_source_do(source, buffer, &read);
+        if (read == 0) break;
+        std::fill(buffer->data + read, buffer->data + hop, 0.0f);
+        filters->advanceFilters(buffer->data);
+        ++hopIndex;
+        if (read < uint_t(hop)) break;
+    }
+    del_fvec(buffer);
+    del_aubio_source(source);
+
+    // Склейка по порядку и последовательный трекер
+    PitchTracker tracker(filters->trackerSettings());
+    const int lag = tracker.latencyHops();
+    frames.reserve(int(hopIndex));
+    const int total = std::max(expectedSegments, int(segments.size()));
+
+    auto pushHop = [&](const PitchCandidate* candidates, int count) {
+        float pitchHz = 0.0f;
+        float confidence = 0.0f;
+        if (tracker.push(candidates, count, pitchHz, confidence)) {
+            const long long decided = frames.size();
+            frames.append({ double(decided) * hop / sampleRate, pitchHz, confidence });
+        }
+    };
+
+    for (int i = 0; i < segments.size(); ++i) {
+        SegmentResult result = segments[i].result();
+        if (!result.error.isEmpty()) {
+            error = result.error;
+            for (int j = i + 1; j < segments.size(); ++j) segments[j].waitForFinished();
+            frames.clear();
+            return false;
+        }
+
+        const PitchCandidate* candidates = result.candidates.data();
+        for (unsigned char count : result.counts) {
+            pushHop(candidates, count);
+            candidates += count;
+        }
+        if (progress) progress(i + 1, total);
+    }
+
+    // Последние lag хопов дорешиваются на тишине
+    for (int i = 0; i < lag && frames.size() < hopIndex; ++i) {
+        pushHop(nullptr, 0);
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef OFFLINEANALYZER_H
+#define OFFLINEANALYZER_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+#include <vector>
+#include "instrumentprofile.h"
+#include "pitchdetector.h"
+
+struct OfflinePitchFrame {
+    double time;        // Начало хопа, с
+    float pitchHz;      // 0 — тишина
+    float confidence;
+};
+
+// Анализ длинной записи на всех ядрах с результатом, совпадающим
+// с последовательным проходом бит в бит.
+//
+// Запись режется на сегменты по segmentSeconds. Один поток быстро проходит
+// файл только через фильтры (децимация и биквады — несколько микросекунд на хоп)
+// и запоминает их состояние в начале каждого сегмента; сегмент сразу уходит
+// в пул потоков. Там он начинается на длину окна раньше своей границы, чтобы
+// окно YIN заполнилось теми же отсчётами, и выдаёт кандидатов по хопам.
+// Трекер (Витерби) зависит от всей истории и дёшев, поэтому в конце он
+// проходит по склеенным кандидатам последовательно.
+class OfflineAnalyzer
+{
+public:
+    struct Settings {
+        InstrumentProfile profile = InstrumentProfile::find("guitar");
+        PreFilter::Settings preFilter;
+        bool decimate = false;
+        int threads = 0;                // 0 — по числу ядер
+        float segmentSeconds = 60.0f;
+    };
+
+    explicit OfflineAnalyzer(const Settings& settings);
+
+    // Вызывается из потока analyze() по мере завершения сегментов
+    void setProgressCallback(std::function<void(int done, int total)> callback) { progress = std::move(callback); }
+
+    // Один кадр на хоп; последние хопы дорешиваются трекером на тишине.
+    // Точное совпадение гарантируется для форматов с точным позиционированием (WAV, FLAC).
+    bool analyze(const QString& path, QVector<OfflinePitchFrame>& frames, QString& error);
+
+private:
+    struct SegmentResult {
+        std::vector<PitchCandidate> candidates;
+        std::vector<unsigned char> counts;  // Число кандидатов каждого хопа
+        QString error;
+    };
+
+    PitchDetector* createDetector(float sampleRate) const;
+    SegmentResult analyzeSegment(const QString& path, float sampleRate, long long firstHop,
+                                 long long startHop, long long endHop,
+                                 const PitchDetector::FilterState& state) const;
+
+    Settings settings;
+    std::function<void(int, int)> progress;
+};
+
+#endif // OFFLINEANALYZER_H
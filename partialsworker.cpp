@@ -0,0 +1,69 @@
+#include "partialsworker.h"
+#include <algorithm>
+
+PartialsWorker::PartialsWorker(QObject *parent)
+    : QObject(parent),
+    configuredRate(0.0f),
+    filled(0),
+    sinceAnalysis(0),
+    interval(0),
+    fundamentalHint(0.0f),
+    lowestFrequency(0.0f)
+{
+    qRegisterMetaType<PartialsResult>("PartialsResult");
+}
+
+void PartialsWorker::reset()
+{
+    std::fill(history.begin(), history.end(), 0.0f);
+    filled = 0;
+    sinceAnalysis = 0;
+    fundamentalHint = 0.0f;
+}
+
+void PartialsWorker::setFundamentalHint(float pitchHz)
+{
+    // Нулевой питч (пауза) не сбрасывает подсказку: нота ещё может звучать
+    if (pitchHz > 0.0f) fundamentalHint = pitchHz;
+}
+
+void PartialsWorker::setLowestFrequency(float hz)
+{
+    if (hz == lowestFrequency) return;
+    lowestFrequency = hz;
+    // Окно пересоздаётся под новую длину на следующем хопе
+    analyzer.reset();
+}
+
+void PartialsWorker::processHop(const QByteArray& raw, const QAudioFormat& format)
+{
+    AudioFrame frame;
+    frame.raw = raw;
+    frame.format = format;
+    if (!converter.process(frame)) return;
+
+    if (!analyzer || configuredRate != format.sampleRate()) {
+        configuredRate = format.sampleRate();
+        analyzer.reset(new InharmonicityAnalyzer(configuredRate,
+                                                 InharmonicityAnalyzer::windowSizeFor(configuredRate, lowestFrequency)));
+        history.assign(analyzer->windowSize(), 0.0f);
+        filled = 0;
+        sinceAnalysis = 0;
+    }
+
+    const int size = int(history.size());
+    const int count = std::min(int(frame.samples.size()), size);
+    std::move(history.begin() + count, history.end(), history.begin());
+    std::copy(frame.samples.end() - count, frame.samples.end(), history.end() - count);
+    filled = std::min(size, filled + count);
+    sinceAnalysis += count;
+
+    const int step = interval > 0 ? interval : size / 4;
+    if (filled < size || sinceAnalysis < step || fundamentalHint <= 0.0f) return;
+    sinceAnalysis = 0;
+
+    PartialsResult result;
+    if (analyzer->analyze(history.data(), fundamentalHint, result)) {
+        emit partialsAnalyzed(result);
+    }
+}
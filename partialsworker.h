@@ -0,0 +1,49 @@
+#ifndef PARTIALSWORKER_H
+#define PARTIALSWORKER_H
+
+#include <QObject>
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QMetaType>
+#include <memory>
+#include <vector>
+#include "graphstages.h"
+#include "inharmonicityanalyzer.h"
+
+Q_DECLARE_METATYPE(PartialsResult)
+
+// Анализ партиалов в отдельном потоке. Хопы приходят сырыми, преобразование
+// и БПФ выполняются здесь; анализ запускается раз в interval отсчётов,
+// а между запусками интерфейс показывает последний результат.
+class PartialsWorker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit PartialsWorker(QObject *parent = nullptr);
+
+    // Отсчётов между анализами (по умолчанию четверть окна)
+    void setInterval(int samples) { interval = samples; }
+
+public slots:
+    void processHop(const QByteArray& raw, const QAudioFormat& format);
+    void setFundamentalHint(float pitchHz);
+    // Нижняя граница профиля: по ней выбирается длина окна анализа
+    void setLowestFrequency(float hz);
+    void reset();
+
+signals:
+    void partialsAnalyzed(const PartialsResult& result);
+
+private:
+    ConverterStage converter;
+    std::unique_ptr<InharmonicityAnalyzer> analyzer;
+    float configuredRate;
+    std::vector<float> history;  // Последние windowSize отсчётов
+    int filled;
+    int sinceAnalysis;
+    int interval;
+    float fundamentalHint;
+    float lowestFrequency;
+};
+
+#endif // PARTIALSWORKER_H
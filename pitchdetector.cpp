@@ -1,41 +1,352 @@
-#include "PitchDetector.h"
+#include "pitchdetector.h"
 #include <QDebug>
+#include <algorithm>
 
 PitchDetector::PitchDetector(float sampleRate, int bufferSize, int hopSize, QObject *parent)
     : QObject(parent),
+    pitch(nullptr),
+    inputBuffer(nullptr),
+    outputBuffer(nullptr),
     sampleRate(sampleRate),
     bufferSize(bufferSize),
-    hopSize(hopSize)
+    hopSize(hopSize),
+    analysisHop(hopSize),
+    lastConfidence(0.0f),
+    minFrequency(PitchTrackerSettings().minFrequency),
+    maxFrequency(PitchTrackerSettings().maxFrequency),
+    trackingEnabled(false),
+    contourHopSize(0),
+    contourStep(0),
+    calibrationHopsLeft(0)
 {
-    pitch = new_aubio_pitch("schmitt", bufferSize, hopSize, sampleRate);
-    if (!pitch) {
-        qCritical() << "Failed to create aubio pitch object.";
+    rebuild();
+}
+
+PitchDetector::~PitchDetector()
+{
+    releaseAubio();
+}
+
+void PitchDetector::releaseAubio()
+{
+    if (pitch) del_aubio_pitch(pitch);
+    if (inputBuffer) del_fvec(inputBuffer);
+    if (outputBuffer) del_fvec(outputBuffer);
+    pitch = nullptr;
+    inputBuffer = nullptr;
+    outputBuffer = nullptr;
+}
+
+void PitchDetector::rebuild()
+{
+    releaseAubio();
+
+    const int factor = decimator.factor();
+    const float rate = sampleRate / factor;
+    const int window = bufferSize / factor;
+    analysisHop = hopSize / factor;
 
+    if (!trackingEnabled) {
+        pitch = new_aubio_pitch("schmitt", window, analysisHop, rate);
+        if (!pitch) {
+            qCritical() << "Failed to create aubio pitch object.";
+
+        }
     }
-    inputBuffer = new_fvec(hopSize);
+    inputBuffer = new_fvec(analysisHop);
     outputBuffer = new_fvec(1);
+    preFilter.configure(preFilterSettings.forRange(minFrequency, maxFrequency), rate);
+
+    contourStep = contourHopSize / factor;
+    if (contourStep > 0 && (contourHopSize % factor != 0 || analysisHop % contourStep != 0)) {
+        qWarning() << "Contour hop" << contourHopSize << "does not divide hop" << hopSize << "- contour disabled";
+        contourStep = 0;
+    }
+
+    if (trackingEnabled || contourStep > 0) {
+        yinKernel.reset(new YinKernel(window, rate, minFrequency, maxFrequency));
+    } else {
+        yinKernel.reset();
+    }
+
+    if (trackingEnabled) {
+        tracker.reset(new PitchTracker(trackerSettings()));
+        // При контуре окно целиком не нужно: разностная функция копится сама
+        if (contourStep == 0) analysisWindow.assign(window, 0.0f);
+        else analysisWindow.clear();
+    } else {
+        tracker.reset();
+        analysisWindow.clear();
+    }
+
+    contourPitchValues.clear();
+    contourConfidenceValues.clear();
+    if (contourStep > 0) {
+        slidingDifference.reset(new SlidingDifference(window, yinKernel->scratchSize()));
+        contourDifference.assign(yinKernel->scratchSize(), 0.0f);
+        contourPitchValues.reserve(analysisHop / contourStep);
+        contourConfidenceValues.reserve(analysisHop / contourStep);
+    } else {
+        slidingDifference.reset();
+        contourDifference.clear();
+    }
+
+    // Спектральному пути нужно окно целиком, как у обычного YIN
+    if (calibrationHopsLeft > 0) {
+        calibrationHopsLeft = 0;
+        emit noiseCalibrationFinished(QVector<float>());
+    }
+    if (!analysisWindow.empty()) {
+        spectralDifference.reset(new SpectralDifference(window, SpectralDifference::Settings()));
+        spectralScratch.assign(yinKernel->scratchSize(), 0.0f);
+        if (!noisePowerSpectrum.empty()) {
+            spectralDifference->setNoiseProfile(noisePowerSpectrum);
+            if (!spectralDifference->hasNoiseProfile()) {
+                qWarning() << "Noise profile does not match analysis window" << window << "- discarded";
+                noisePowerSpectrum.clear();
+            }
+        }
+    } else {
+        spectralDifference.reset();
+        spectralScratch.clear();
+    }
 }
 
-PitchDetector::~PitchDetector()
+float PitchDetector::confidence() const
 {
-    del_aubio_pitch(pitch);
-    del_fvec(inputBuffer);
-    del_fvec(outputBuffer);
+    return lastConfidence;
 }
 
-void PitchDetector::processAudio(const float* audioData)
+void PitchDetector::setPreFilterSettings(const PreFilter::Settings& settings)
+{
+    preFilterSettings = settings;
+    preFilter.configure(settings.forRange(minFrequency, maxFrequency), analysisSampleRate());
+}
+
+void PitchDetector::setTrackingEnabled(bool enabled)
+{
+    if (trackingEnabled == enabled) return;
+
+    trackingEnabled = enabled;
+    rebuild();
+}
+
+PitchTracker::Settings PitchDetector::trackerSettings() const
+{
+    PitchTracker::Settings settings;
+    settings.minFrequency = minFrequency;
+    settings.maxFrequency = maxFrequency;
+    return settings;
+}
+
+void PitchDetector::setFrequencyRange(float minHz, float maxHz)
+{
+    if (minHz <= 0.0f || maxHz <= minHz) {
+        qWarning() << "Invalid frequency range" << minHz << "-" << maxHz;
+        return;
+    }
+    if (minHz == minFrequency && maxHz == maxFrequency) return;
+
+    minFrequency = minHz;
+    maxFrequency = maxHz;
+    rebuild();
+}
+
+void PitchDetector::setDecimationFactor(int factor)
+{
+    if (factor < 1 || hopSize % factor != 0 || bufferSize % factor != 0) {
+        qWarning() << "Unsupported decimation factor" << factor << "for hop" << hopSize;
+        factor = 1;
+    }
+    if (factor == decimator.factor()) return;
+
+    decimator.configure(factor);
+    rebuild();
+}
+
+void PitchDetector::setContourHop(int samples)
+{
+    if (samples < 0) samples = 0;
+    if (samples == contourHopSize) return;
+
+    contourHopSize = samples;
+    rebuild();
+}
+
+bool PitchDetector::setNoiseProfile(const QVector<float>& powerSpectrum)
+{
+    if (!spectralDifference) {
+        qWarning() << "Noise reduction needs pitch tracking without contour";
+        return false;
+    }
+    spectralDifference->setNoiseProfile(std::vector<float>(powerSpectrum.begin(), powerSpectrum.end()));
+    if (!spectralDifference->hasNoiseProfile()) {
+        qWarning() << "Noise profile of" << powerSpectrum.size() << "bins does not match"
+                   << spectralDifference->spectrumSize();
+        noisePowerSpectrum.clear();
+        return false;
+    }
+    noisePowerSpectrum = spectralDifference->noiseProfile();
+    return true;
+}
+
+QVector<float> PitchDetector::noiseProfile() const
 {
-    if (!pitch) {
-        emit pitchDetected(0.0f);
+    return QVector<float>(noisePowerSpectrum.begin(), noisePowerSpectrum.end());
+}
+
+void PitchDetector::startNoiseCalibration(int hops)
+{
+    if (!spectralDifference || hops <= 0) {
+        qWarning() << "Noise calibration is not available in this detector mode";
+        emit noiseCalibrationFinished(QVector<float>());
         return;
     }
+    spectralDifference->beginCalibration();
+    calibrationHopsLeft = hops;
+}
+
+void PitchDetector::clearNoiseProfile()
+{
+    noisePowerSpectrum.clear();
+    if (spectralDifference) spectralDifference->clearNoiseProfile();
+}
 
-    for (int i = 0; i < hopSize; ++i) {
+void PitchDetector::advanceNoiseCalibration()
+{
+    if (calibrationHopsLeft == 0 || --calibrationHopsLeft > 0) return;
 
-        inputBuffer->data[i] = audioData[i];
+    if (spectralDifference->endCalibration()) {
+        noisePowerSpectrum = spectralDifference->noiseProfile();
+        qDebug() << "Noise profile learned from" << spectralDifference->calibrationFrames() << "windows";
+        emit noiseCalibrationFinished(noiseProfile());
+    } else {
+        emit noiseCalibrationFinished(QVector<float>());
+    }
+}
+
+int PitchDetector::bestCandidate(const PitchCandidate* candidates, int count) const
+{
+    int best = -1;
+    for (int i = 0; i < count; ++i) {
+        if (best < 0 || candidates[i].probability > candidates[best].probability) best = i;
+    }
+    return best;
+}
+
+PitchDetector::FilterState PitchDetector::filterState() const
+{
+    return { decimator, preFilter };
+}
+
+void PitchDetector::restoreFilterState(const FilterState& state)
+{
+    decimator = state.decimator;
+    preFilter = state.preFilter;
+}
+
+void PitchDetector::conditionHop(const float* audioData)
+{
+    // Прореживание (или простое копирование при factor == 1)
+    decimator.process(audioData, hopSize, inputBuffer->data);
+
+    // Убираем постоянную составляющую, гул и сетевую наводку до детектора
+    preFilter.process(inputBuffer->data, analysisHop);
+}
+
+void PitchDetector::advanceFilters(const float* audioData)
+{
+    conditionHop(audioData);
+}
+
+int PitchDetector::candidatesForHop(PitchCandidate* candidates)
+{
+    int count = 0;
+
+    if (slidingDifference) {
+        // Контур: по точке на каждый под-хоп. Последняя точка соответствует
+        // полному окну хопа, её кандидаты идут в трекер без повторного расчёта.
+        contourPitchValues.clear();
+        contourConfidenceValues.clear();
+        for (int offset = 0; offset < analysisHop; offset += contourStep) {
+            slidingDifference->push(inputBuffer->data + offset, contourStep);
+            slidingDifference->copyTo(contourDifference.data());
+            count = yinKernel->candidatesFromDifference(contourDifference.data(), candidates,
+                                                        YinKernel::MAX_CANDIDATES);
+            int best = bestCandidate(candidates, count);
+            contourPitchValues.append(best >= 0 ? candidates[best].frequency : 0.0f);
+            contourConfidenceValues.append(best >= 0 ? candidates[best].probability : 0.0f);
+        }
+    } else if (!analysisWindow.empty()) {
+        std::move(analysisWindow.begin() + analysisHop, analysisWindow.end(), analysisWindow.begin());
+        std::copy(inputBuffer->data, inputBuffer->data + analysisHop, analysisWindow.end() - analysisHop);
+        if (spectralDifference && (spectralDifference->isCalibrating() || spectralDifference->hasNoiseProfile())) {
+            // Один БПФ окна: и накопление шума, и очищенная разностная функция
+            spectralDifference->compute(analysisWindow.data(), spectralScratch.data(), yinKernel->scratchSize());
+            count = yinKernel->candidatesFromDifference(spectralScratch.data(), candidates,
+                                                        YinKernel::MAX_CANDIDATES);
+        } else {
+            count = yinKernel->analyze(analysisWindow.data(), candidates, YinKernel::MAX_CANDIDATES);
+        }
+    }
+    return count;
+}
+
+int PitchDetector::analyzeCandidates(const float* audioData, PitchCandidate* out)
+{
+    if (!yinKernel) return 0;
+
+    conditionHop(audioData);
+    return candidatesForHop(out);
+}
+
+float PitchDetector::detect(const float* audioData)
+{
+    if (!pitch && !tracker) {
+        lastConfidence = 0.0f;
+        return 0.0f;
+    }
+
+    conditionHop(audioData);
+
+    PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+    int count = candidatesForHop(candidates);
+    advanceNoiseCalibration();
+
+    if (tracker) {
+        // Пока не набралась задержка декодера, решения ещё нет
+        float trackedHz = 0.0f;
+        if (!tracker->push(candidates, count, trackedHz, lastConfidence)) {
+            lastConfidence = 0.0f;
+        }
+        return trackedHz;
     }
 
     aubio_pitch_do(pitch, inputBuffer, outputBuffer);
+    lastConfidence = aubio_pitch_get_confidence(pitch);
+
+    const float detectedHz = outputBuffer->data[0];
+    if (detectedHz < minFrequency || detectedHz > maxFrequency) {
+        lastConfidence = 0.0f;
+        return 0.0f;
+    }
+    return detectedHz;
+}
 
-    emit pitchDetected(outputBuffer->data[0]);
+void PitchDetector::resetState()
+{
+    decimator.reset();
+    preFilter.reset();
+    std::fill(analysisWindow.begin(), analysisWindow.end(), 0.0f);
+    if (tracker) tracker->reset();
+    if (slidingDifference) slidingDifference->reset();
+    lastConfidence = 0.0f;
+}
+
+void PitchDetector::processAudio(const float* audioData)
+{
+    emit pitchDetected(detect(audioData));
+    if (slidingDifference) {
+        emit pitchContour(contourPitchValues, contourConfidenceValues);
+    }
 }
@@ -2,7 +2,16 @@
 #define PITCHDETECTOR_H
 
 #include <QObject>
+#include <QVector>
 #include <aubio/aubio.h>
+#include <memory>
+#include <vector>
+#include "decimator.h"
+#include "prefilter.h"
+#include "pitchtracker.h"
+#include "slidingdifference.h"
+#include "spectraldifference.h"
+#include "yinkernel.h"
 
 class PitchDetector : public QObject
 {
@@ -11,20 +20,118 @@ public:
     explicit PitchDetector(float sampleRate, int bufferSize, int hopSize, QObject *parent = nullptr);
     ~PitchDetector();
 
+    float confidence() const;
+    void setPreFilterSettings(const PreFilter::Settings& settings);
+
+    // Трекинг по HMM: несколько кандидатов YIN на хоп + Витерби с фиксированной задержкой
+    void setTrackingEnabled(bool enabled);
+    bool isTrackingEnabled() const { return trackingEnabled; }
+
+    // Диапазон основного тона инструмента: ограничивает поиск YIN и состояния трекера,
+    // у aubio отбрасывает результаты вне диапазона
+    void setFrequencyRange(float minFrequency, float maxFrequency);
+    float minimumFrequency() const { return minFrequency; }
+    float maximumFrequency() const { return maxFrequency; }
+
+    // Понижение частоты дискретизации перед анализом (1, 2, 4 или 8).
+    // Окно и хоп детектора сокращаются в factor раз, длительность окна сохраняется.
+    void setDecimationFactor(int factor);
+    int decimationFactor() const { return decimator.factor(); }
+    float analysisSampleRate() const { return sampleRate / decimator.factor(); }
+
+    // Плотный контур питча: оценка каждые contourHop входных отсчётов (0 — выкл.).
+    // Разностная функция обновляется инкрементально, так что цена не зависит от окна.
+    // hopSize должен делиться на contourHop (с учётом децимации).
+    void setContourHop(int samples);
+    int contourHop() const { return contourHopSize; }
+    // Точки контура последнего хопа, от старых к новым
+    const QVector<float>& contourPitches() const { return contourPitchValues; }
+    const QVector<float>& contourConfidences() const { return contourConfidenceValues; }
+
+    // Подавление фонового шума (вентиляторы, компрессор): профиль шума учится
+    // по спектрам окон без игры и вычитается из спектра каждого окна перед YIN.
+    // Работает только с трекингом и без контура; профиль переживает смену настроек,
+    // пока не меняется размер окна анализа.
+    bool isNoiseReductionAvailable() const { return spectralDifference != nullptr; }
+    // false, если размер профиля не подходит к текущему окну
+    bool setNoiseProfile(const QVector<float>& powerSpectrum);
+    QVector<float> noiseProfile() const;
+    bool isCalibratingNoise() const { return calibrationHopsLeft > 0; }
+
+    // Трекер с теми же настройками, что использует детектор
+    PitchTracker::Settings trackerSettings() const;
+
+    // Состояние фильтров перед детектором (децимация и каскад биквадов).
+    // Восстановив его, можно продолжить обработку с любого хопа ровно так же,
+    // как при последовательном проходе; окно анализа заполняется заново.
+    struct FilterState {
+        PolyphaseDecimator decimator;
+        PreFilter preFilter;
+    };
+    FilterState filterState() const;
+    void restoreFilterState(const FilterState& state);
+    // Только фильтры, без детектора: быстрая перемотка до нужного хопа
+    void advanceFilters(const float* audioData);
+    // Фильтры и YIN без трекера; out — на YinKernel::MAX_CANDIDATES.
+    // Работает при включённом трекинге или контуре, иначе возвращает 0.
+    int analyzeCandidates(const float* audioData, PitchCandidate* out);
+
+    // Синхронная обработка одного хопа, возвращает питч в Гц (0 — нет сигнала)
+    float detect(const float* audioData);
+
 public slots:
     void processAudio(const float* audioData);
+    // Забывает окно, трекер и состояние фильтров (после паузы в потоке звука)
+    void resetState();
+    // Следующие hops хопов считаются шумом; по окончании — noiseCalibrationFinished
+    void startNoiseCalibration(int hops);
+    void clearNoiseProfile();
 
 signals:
     void pitchDetected(float pitchHz);
+    // Раз в хоп, если включён контур: hopSize / contourHop точек
+    void pitchContour(const QVector<float>& pitches, const QVector<float>& confidences);
+    // Выученный спектр мощности шума; пустой, если калибровка не удалась
+    void noiseCalibrationFinished(const QVector<float>& powerSpectrum);
 
 private:
+    void rebuild();
+    void releaseAubio();
+    int bestCandidate(const PitchCandidate* candidates, int count) const;
+    void conditionHop(const float* audioData);
+    int candidatesForHop(PitchCandidate* candidates);
+    void advanceNoiseCalibration();
+
     aubio_pitch_t* pitch;
     fvec_t* inputBuffer;
     fvec_t* outputBuffer;
     float sampleRate;
     int bufferSize;
     int hopSize;
+    int analysisHop;
+    PreFilter preFilter;
+    PreFilter::Settings preFilterSettings;
+    PolyphaseDecimator decimator;
+    float lastConfidence;
+    float minFrequency;
+    float maxFrequency;
+
+    bool trackingEnabled;
+    std::unique_ptr<YinKernel> yinKernel;
+    std::unique_ptr<PitchTracker> tracker;
+    std::vector<float> analysisWindow;
+
+    int contourHopSize;
+    int contourStep;
+    std::unique_ptr<SlidingDifference> slidingDifference;
+    std::vector<float> contourDifference;
+    QVector<float> contourPitchValues;
+    QVector<float> contourConfidenceValues;
 
+    std::unique_ptr<SpectralDifference> spectralDifference;
+    std::vector<float> spectralScratch;
+    std::vector<float> noisePowerSpectrum;
+    int calibrationHopsLeft;
 };
 
 #endif // PITCHDETECTOR_H
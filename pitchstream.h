@@ -0,0 +1,68 @@
+#ifndef PITCHSTREAM_H
+#define PITCHSTREAM_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Формат сегмента разделяемой памяти, через который результаты питча
+// публикуются для других локальных процессов.
+//
+// Писатель один (QtAudioRecorder), читателей может быть сколько угодно.
+// Писатель записывает в заголовок свой PID; другой тюнер забирает сегмент,
+// только если этот процесс уже не существует.
+// Каждая запись защищена собственным счётчиком последовательности (seqlock):
+// нечётное значение означает, что запись сейчас перезаписывается.
+// Читатели ничего не пишут в сегмент и никак не тормозят писателя.
+namespace PitchStream {
+
+const char SEGMENT_KEY[] = "TunerPitchStream";
+const quint32 MAGIC = 0x524E5554; // "TUNR"
+const quint32 VERSION = 2;
+const quint32 RING_CAPACITY = 1024; // Должна быть степенью двойки
+
+struct alignas(64) Header {
+    quint32 magic;
+    quint32 version;
+    quint32 capacity;
+    quint32 recordSize;
+    float sampleRate;
+    quint32 hopSize;
+    std::atomic<quint32> sessionId;  // Меняется при каждом открытии писателем
+    std::atomic<quint64> writeCount; // Число опубликованных записей
+    std::atomic<qint64> writerPid;   // Процесс-писатель, 0 — сегмент свободен
+};
+
+// Каждая запись занимает свою кэш-линию, чтобы читатели соседних
+// записей не конкурировали с писателем.
+struct alignas(64) Record {
+    std::atomic<quint32> sequence;
+    quint32 reserved;
+    quint64 hopIndex;
+    qint64 timestampNs; // steady_clock, общий для всех процессов машины
+    float pitchHz;
+    float confidence;
+};
+
+static_assert(std::atomic<quint32>::is_always_lock_free, "seqlock requires lock-free 32-bit atomics");
+static_assert(std::atomic<quint64>::is_always_lock_free, "seqlock requires lock-free 64-bit atomics");
+static_assert(sizeof(Header) == 64, "Header must stay one cache line");
+static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0, "RING_CAPACITY must be a power of two");
+
+inline int segmentSize()
+{
+    return int(sizeof(Header) + RING_CAPACITY * sizeof(Record));
+}
+
+inline Record* records(void* base)
+{
+    return reinterpret_cast<Record*>(static_cast<char*>(base) + sizeof(Header));
+}
+
+inline const Record* records(const void* base)
+{
+    return reinterpret_cast<const Record*>(static_cast<const char*>(base) + sizeof(Header));
+}
+
+} // namespace PitchStream
+
+#endif // PITCHSTREAM_H
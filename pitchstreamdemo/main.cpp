@@ -0,0 +1,44 @@
+// Демонстрационный потребитель потока питча из разделяемой памяти.
+// Запускается рядом с работающим Tuner --pitch-stream и печатает каждый хоп.
+
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QTimer>
+#include "pitchstreamreader.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QTextStream out(stdout);
+
+    PitchStreamReader reader;
+    quint64 reportedDrops = 0;
+
+    QTimer pollTimer;
+    QObject::connect(&pollTimer, &QTimer::timeout, [&]() {
+        if (!reader.isAttached()) {
+            if (!reader.attach()) return;
+            out << "Attached: " << reader.sampleRate() << " Hz, hop " << reader.hopSize() << Qt::endl;
+        }
+
+        PitchSample samples[64];
+        int count;
+        while ((count = reader.read(samples, 64)) > 0) {
+            for (int i = 0; i < count; ++i) {
+                out << samples[i].hopIndex << '\t'
+                    << samples[i].timestampNs << '\t'
+                    << QString::number(samples[i].pitchHz, 'f', 2) << '\t'
+                    << QString::number(samples[i].confidence, 'f', 3) << '\n';
+            }
+            out.flush();
+        }
+
+        if (reader.droppedCount() != reportedDrops) {
+            reportedDrops = reader.droppedCount();
+            out << "Dropped records: " << reportedDrops << Qt::endl;
+        }
+    });
+    pollTimer.start(10);
+
+    return a.exec();
+}
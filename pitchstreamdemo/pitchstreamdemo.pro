@@ -0,0 +1,17 @@
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = pitchstreamdemo
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    main.cpp \
+    ../pitchstreamreader.cpp
+
+HEADERS += \
+    ../pitchstream.h \
+    ../pitchstreamreader.h
@@ -0,0 +1,134 @@
+#include "pitchstreampublisher.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <signal.h>
+#endif
+
+// Жив ли процесс, записанный владельцем сегмента
+static bool processAlive(qint64 pid)
+{
+    if (pid <= 0) return false;
+#ifdef Q_OS_WIN
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, DWORD(pid));
+    if (!process) return GetLastError() == ERROR_ACCESS_DENIED;
+    DWORD exitCode = 0;
+    const bool alive = GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE;
+    CloseHandle(process);
+    return alive;
+#else
+    return kill(pid_t(pid), 0) == 0 || errno == EPERM;
+#endif
+}
+
+PitchStreamPublisher::PitchStreamPublisher()
+    : sharedMemory(QString::fromLatin1(PitchStream::SEGMENT_KEY)),
+    header(nullptr),
+    ring(nullptr)
+{
+}
+
+PitchStreamPublisher::~PitchStreamPublisher()
+{
+    close();
+}
+
+bool PitchStreamPublisher::open(float sampleRate, int hopSize)
+{
+    if (isOpen()) return true;
+
+    if (!sharedMemory.create(PitchStream::segmentSize())) {
+        // Сегмент мог остаться от упавшего процесса — переиспользуем его
+        if (sharedMemory.error() != QSharedMemory::AlreadyExists || !sharedMemory.attach()) {
+            qWarning() << "Failed to create pitch stream segment:" << sharedMemory.errorString();
+            return false;
+        }
+        if (sharedMemory.size() < PitchStream::segmentSize()) {
+            qWarning() << "Existing pitch stream segment is too small:" << sharedMemory.size();
+            sharedMemory.detach();
+            return false;
+        }
+    }
+
+    // Проверка и захват владельца под системной блокировкой сегмента,
+    // чтобы два тюнера не стали писателями одновременно
+    void* base = sharedMemory.data();
+    PitchStream::Header* candidate = static_cast<PitchStream::Header*>(base);
+    const qint64 ownPid = QCoreApplication::applicationPid();
+    sharedMemory.lock();
+    const qint64 owner = candidate->writerPid.load(std::memory_order_acquire);
+    if (owner != ownPid && processAlive(owner)) {
+        sharedMemory.unlock();
+        qWarning() << "Pitch stream segment is owned by running process" << owner;
+        sharedMemory.detach();
+        return false;
+    }
+    candidate->writerPid.store(ownPid, std::memory_order_release);
+    sharedMemory.unlock();
+
+    header = candidate;
+    ring = PitchStream::records(base);
+
+    // Пока magic обнулён, читатели считают сегмент неготовым
+    header->magic = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header->version = PitchStream::VERSION;
+    header->capacity = PitchStream::RING_CAPACITY;
+    header->recordSize = sizeof(PitchStream::Record);
+    header->sampleRate = sampleRate;
+    header->hopSize = quint32(hopSize);
+    header->writeCount.store(0, std::memory_order_relaxed);
+    for (quint32 i = 0; i < PitchStream::RING_CAPACITY; ++i) {
+        ring[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    header->sessionId.fetch_add(1, std::memory_order_relaxed);
+
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = PitchStream::MAGIC;
+
+    qDebug() << "Pitch stream published at key" << PitchStream::SEGMENT_KEY;
+    return true;
+}
+
+void PitchStreamPublisher::close()
+{
+    if (!isOpen()) return;
+
+    header->magic = 0;
+    sharedMemory.lock();
+    if (header->writerPid.load(std::memory_order_relaxed) == QCoreApplication::applicationPid()) {
+        header->writerPid.store(0, std::memory_order_release);
+    }
+    sharedMemory.unlock();
+    header = nullptr;
+    ring = nullptr;
+    sharedMemory.detach();
+}
+
+void PitchStreamPublisher::publish(float pitchHz, float confidence)
+{
+    if (!header) return;
+
+    const quint64 index = header->writeCount.load(std::memory_order_relaxed);
+    PitchStream::Record& record = ring[index & (PitchStream::RING_CAPACITY - 1)];
+
+    const quint32 sequence = record.sequence.load(std::memory_order_relaxed);
+    record.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    record.hopIndex = index;
+    record.timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch()).count();
+    record.pitchHz = pitchHz;
+    record.confidence = confidence;
+
+    record.sequence.store(sequence + 2, std::memory_order_release);
+    header->writeCount.store(index + 1, std::memory_order_release);
+}
@@ -0,0 +1,28 @@
+#ifndef PITCHSTREAMPUBLISHER_H
+#define PITCHSTREAMPUBLISHER_H
+
+#include <QSharedMemory>
+#include "pitchstream.h"
+
+// Публикует результаты каждого хопа в кольцевой буфер разделяемой памяти.
+// publish() вызывается из потока обработки и не блокируется.
+class PitchStreamPublisher
+{
+public:
+    PitchStreamPublisher();
+    ~PitchStreamPublisher();
+
+    bool open(float sampleRate, int hopSize);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+    QString errorString() const { return sharedMemory.errorString(); }
+
+    void publish(float pitchHz, float confidence);
+
+private:
+    QSharedMemory sharedMemory;
+    PitchStream::Header* header;
+    PitchStream::Record* ring;
+};
+
+#endif // PITCHSTREAMPUBLISHER_H
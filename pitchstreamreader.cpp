@@ -0,0 +1,120 @@
+#include "pitchstreamreader.h"
+
+PitchStreamReader::PitchStreamReader()
+    : sharedMemory(QString::fromLatin1(PitchStream::SEGMENT_KEY)),
+    header(nullptr),
+    ring(nullptr),
+    nextIndex(0),
+    sessionId(0),
+    dropped(0)
+{
+}
+
+PitchStreamReader::~PitchStreamReader()
+{
+    detach();
+}
+
+bool PitchStreamReader::attach()
+{
+    if (isAttached()) return true;
+
+    if (!sharedMemory.attach(QSharedMemory::ReadOnly)) {
+        return false;
+    }
+    if (sharedMemory.size() < PitchStream::segmentSize()) {
+        sharedMemory.detach();
+        return false;
+    }
+
+    const void* base = sharedMemory.constData();
+    header = static_cast<const PitchStream::Header*>(base);
+    ring = PitchStream::records(base);
+
+    // Начинаем с текущего конца потока, историю не перечитываем
+    sessionId = header->sessionId.load(std::memory_order_acquire);
+    nextIndex = header->writeCount.load(std::memory_order_acquire);
+    dropped = 0;
+    return true;
+}
+
+void PitchStreamReader::detach()
+{
+    if (!isAttached()) return;
+
+    header = nullptr;
+    ring = nullptr;
+    sharedMemory.detach();
+}
+
+float PitchStreamReader::sampleRate() const
+{
+    return header ? header->sampleRate : 0.0f;
+}
+
+int PitchStreamReader::hopSize() const
+{
+    return header ? int(header->hopSize) : 0;
+}
+
+bool PitchStreamReader::readRecord(quint64 index, PitchSample& out) const
+{
+    const PitchStream::Record& record = ring[index & (PitchStream::RING_CAPACITY - 1)];
+
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        const quint32 before = record.sequence.load(std::memory_order_acquire);
+        if (before & 1u) continue; // Писатель в середине записи
+
+        out.hopIndex = record.hopIndex;
+        out.timestampNs = record.timestampNs;
+        out.pitchHz = record.pitchHz;
+        out.confidence = record.confidence;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (record.sequence.load(std::memory_order_relaxed) == before) {
+            // Запись могла быть уже перезаписана более новым хопом
+            return out.hopIndex == index;
+        }
+    }
+    return false;
+}
+
+int PitchStreamReader::read(PitchSample* out, int maxCount)
+{
+    if (!header || header->magic != PitchStream::MAGIC) return 0;
+
+    const quint32 session = header->sessionId.load(std::memory_order_acquire);
+    const quint64 writeCount = header->writeCount.load(std::memory_order_acquire);
+
+    // Писатель перезапустился — начинаем новый поток с начала
+    if (session != sessionId || writeCount < nextIndex) {
+        sessionId = session;
+        nextIndex = 0;
+    }
+
+    if (writeCount - nextIndex > PitchStream::RING_CAPACITY) {
+        const quint64 oldest = writeCount - PitchStream::RING_CAPACITY;
+        dropped += oldest - nextIndex;
+        nextIndex = oldest;
+    }
+
+    int count = 0;
+    while (nextIndex < writeCount && count < maxCount) {
+        if (readRecord(nextIndex, out[count])) {
+            ++count;
+        } else {
+            ++dropped;
+        }
+        ++nextIndex;
+    }
+    return count;
+}
+
+bool PitchStreamReader::latest(PitchSample& out) const
+{
+    if (!header || header->magic != PitchStream::MAGIC) return false;
+
+    const quint64 writeCount = header->writeCount.load(std::memory_order_acquire);
+    if (writeCount == 0) return false;
+    return readRecord(writeCount - 1, out);
+}
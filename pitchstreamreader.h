@@ -0,0 +1,49 @@
+#ifndef PITCHSTREAMREADER_H
+#define PITCHSTREAMREADER_H
+
+#include <QSharedMemory>
+#include "pitchstream.h"
+
+struct PitchSample {
+    quint64 hopIndex;
+    qint64 timestampNs;
+    float pitchHz;
+    float confidence;
+};
+
+// Читатель потока питча из разделяемой памяти.
+// Ничего не пишет в сегмент, поэтому не влияет ни на писателя, ни на других читателей.
+// Если читатель отстал больше чем на размер кольца, пропущенные записи
+// учитываются в droppedCount().
+class PitchStreamReader
+{
+public:
+    PitchStreamReader();
+    ~PitchStreamReader();
+
+    bool attach();
+    void detach();
+    bool isAttached() const { return header != nullptr; }
+    QString errorString() const { return sharedMemory.errorString(); }
+
+    // Возвращает число прочитанных новых записей (не больше maxCount)
+    int read(PitchSample* out, int maxCount);
+    // Последняя опубликованная запись
+    bool latest(PitchSample& out) const;
+
+    float sampleRate() const;
+    int hopSize() const;
+    quint64 droppedCount() const { return dropped; }
+
+private:
+    bool readRecord(quint64 index, PitchSample& out) const;
+
+    QSharedMemory sharedMemory;
+    const PitchStream::Header* header;
+    const PitchStream::Record* ring;
+    quint64 nextIndex;
+    quint32 sessionId;
+    quint64 dropped;
+};
+
+#endif // PITCHSTREAMREADER_H
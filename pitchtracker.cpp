@@ -0,0 +1,162 @@
+#include "pitchtracker.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const float LOG_FLOOR = -1e30f;
+const float MIN_PROBABILITY = 1e-6f;
+}
+
+PitchTracker::PitchTracker(const Settings& settings)
+    : config(settings)
+{
+    float rangeCents = 1200.0f * std::log2(config.maxFrequency / config.minFrequency);
+    binCount = std::max(1, int(std::ceil(rangeCents / config.binCents)) + 1);
+    bandWidth = std::max(1, int(config.maxJumpCents / config.binCents));
+    config.lagHops = std::max(0, config.lagHops);
+
+    // Треугольное распределение скачка, нормированное по ленте
+    logPitchTransition.resize(2 * bandWidth + 1);
+    float total = 0.0f;
+    for (int offset = -bandWidth; offset <= bandWidth; ++offset) {
+        total += float(bandWidth + 1 - std::abs(offset));
+    }
+    for (int offset = -bandWidth; offset <= bandWidth; ++offset) {
+        logPitchTransition[offset + bandWidth] = std::log(float(bandWidth + 1 - std::abs(offset)) / total);
+    }
+    logStay = std::log(1.0f - config.voicingSwitchProbability);
+    logSwitch = std::log(config.voicingSwitchProbability);
+
+    const int states = 2 * binCount;
+    const int slots = config.lagHops + 1;
+    delta.resize(states);
+    nextDelta.resize(states);
+    emission.resize(states);
+    backPointers.resize(size_t(slots) * states);
+    history.resize(size_t(slots) * YinKernel::MAX_CANDIDATES);
+    historyCount.resize(slots);
+    historyVoicing.resize(slots);
+
+    reset();
+}
+
+void PitchTracker::reset()
+{
+    std::fill(delta.begin(), delta.end(), 0.0f);
+    std::fill(historyCount.begin(), historyCount.end(), 0);
+    hopCount = 0;
+}
+
+int PitchTracker::binForFrequency(float frequencyHz) const
+{
+    return int(std::lround(1200.0f * std::log2(frequencyHz / config.minFrequency) / config.binCents));
+}
+
+float PitchTracker::binFrequency(int bin) const
+{
+    return config.minFrequency * std::pow(2.0f, bin * config.binCents / 1200.0f);
+}
+
+bool PitchTracker::push(const PitchCandidate* candidates, int count, float& frequencyHz, float& confidence)
+{
+    const int states = 2 * binCount;
+    const int slots = config.lagHops + 1;
+    const int slot = int(hopCount % slots);
+
+    // Эмиссии: вокализованная полоса получает вероятность своих кандидатов,
+    // невокализованные делят остаток поровну
+    std::fill(emission.begin(), emission.begin() + binCount, 0.0f);
+    float voicedProbability = 0.0f;
+    int stored = 0;
+    for (int i = 0; i < count; ++i) {
+        int bin = binForFrequency(candidates[i].frequency);
+        if (bin < 0 || bin >= binCount) continue;
+        emission[bin] += candidates[i].probability;
+        voicedProbability += candidates[i].probability;
+        if (stored < YinKernel::MAX_CANDIDATES) {
+            history[size_t(slot) * YinKernel::MAX_CANDIDATES + stored++] = candidates[i];
+        }
+    }
+    historyCount[slot] = stored;
+    historyVoicing[slot] = voicedProbability;
+
+    const float unvoiced = std::log(std::max(MIN_PROBABILITY, (1.0f - voicedProbability) / binCount));
+    for (int bin = 0; bin < binCount; ++bin) {
+        emission[bin] = std::log(std::max(MIN_PROBABILITY, emission[bin]));
+        emission[binCount + bin] = unvoiced;
+    }
+
+    // Шаг Витерби по ленточной матрице переходов
+    int* pointers = &backPointers[size_t(slot) * states];
+    float best = LOG_FLOOR;
+    int bestState = 0;
+    for (int target = 0; target < states; ++target) {
+        const bool targetVoiced = target < binCount;
+        const int targetBin = targetVoiced ? target : target - binCount;
+        const int from = std::max(0, targetBin - bandWidth);
+        const int to = std::min(binCount - 1, targetBin + bandWidth);
+
+        float bestScore = LOG_FLOOR;
+        int bestSource = 0;
+        for (int sourceBin = from; sourceBin <= to; ++sourceBin) {
+            const float jump = logPitchTransition[targetBin - sourceBin + bandWidth];
+            const float sameVoicing = delta[targetVoiced ? sourceBin : binCount + sourceBin] + jump + logStay;
+            const float otherVoicing = delta[targetVoiced ? binCount + sourceBin : sourceBin] + jump + logSwitch;
+            if (sameVoicing > bestScore) {
+                bestScore = sameVoicing;
+                bestSource = targetVoiced ? sourceBin : binCount + sourceBin;
+            }
+            if (otherVoicing > bestScore) {
+                bestScore = otherVoicing;
+                bestSource = targetVoiced ? binCount + sourceBin : sourceBin;
+            }
+        }
+
+        nextDelta[target] = bestScore + emission[target];
+        pointers[target] = bestSource;
+        if (nextDelta[target] > best) {
+            best = nextDelta[target];
+            bestState = target;
+        }
+    }
+
+    // Нормируем, чтобы лог-вероятности не уходили в минус бесконечность
+    for (int state = 0; state < states; ++state) {
+        delta[state] = nextDelta[state] - best;
+    }
+
+    ++hopCount;
+    if (hopCount <= config.lagHops) {
+        return false;
+    }
+
+    // Обратный проход на lagHops шагов от лучшего текущего состояния
+    int state = bestState;
+    int currentSlot = slot;
+    for (int step = 0; step < config.lagHops; ++step) {
+        state = backPointers[size_t(currentSlot) * states + state];
+        currentSlot = (currentSlot + slots - 1) % slots;
+    }
+
+    if (state >= binCount) {
+        frequencyHz = 0.0f;
+        confidence = 1.0f - historyVoicing[currentSlot];
+        return true;
+    }
+
+    // Уточняем частоту ближайшим кандидатом того хопа, попавшим в полосу
+    frequencyHz = binFrequency(state);
+    confidence = historyVoicing[currentSlot];
+    const PitchCandidate* decided = &history[size_t(currentSlot) * YinKernel::MAX_CANDIDATES];
+    float bestDistance = std::numeric_limits<float>::max();
+    for (int i = 0; i < historyCount[currentSlot]; ++i) {
+        int bin = binForFrequency(decided[i].frequency);
+        float distance = float(std::abs(bin - state));
+        if (distance <= 1.0f && distance < bestDistance) {
+            bestDistance = distance;
+            frequencyHz = decided[i].frequency;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef PITCHTRACKER_H
+#define PITCHTRACKER_H
+
+#include <vector>
+#include "yinkernel.h"
+
+struct PitchTrackerSettings {
+    float minFrequency = 50.0f;
+    float maxFrequency = 1500.0f;
+    float binCents = 20.0f;
+    float maxJumpCents = 200.0f;            // Максимальный скачок за один хоп
+    float voicingSwitchProbability = 0.01f;
+    int lagHops = 8;
+};
+
+// Трекинг питча по скрытой марковской модели (как в pYIN).
+// Состояния — полосы частоты по binCents центов, каждая в вокализованном
+// и невокализованном варианте. Декодирование — онлайн-Витерби с фиксированной
+// задержкой: решение для хопа t принимается на хопе t + lagHops, а буферы
+// обратных ссылок имеют фиксированный размер, так что стоимость хопа постоянна.
+class PitchTracker
+{
+public:
+    typedef PitchTrackerSettings Settings;
+
+    explicit PitchTracker(const Settings& settings = Settings());
+
+    void reset();
+
+    // Добавляет кандидатов очередного хопа. Возвращает true, если принято
+    // решение для хопа, отстоящего на latencyHops() назад; frequencyHz = 0 — тишина.
+    bool push(const PitchCandidate* candidates, int count, float& frequencyHz, float& confidence);
+
+    int latencyHops() const { return config.lagHops; }
+    const Settings& settings() const { return config; }
+
+private:
+    int binForFrequency(float frequencyHz) const;
+    float binFrequency(int bin) const;
+
+    Settings config;
+    int binCount;
+    int bandWidth;                      // Максимальный скачок в полосах
+    std::vector<float> logPitchTransition; // Ленточная матрица: смещение -> log веса
+    float logStay;
+    float logSwitch;
+
+    std::vector<float> delta;           // Лог-вероятности путей, 2 * binCount
+    std::vector<float> nextDelta;
+    std::vector<float> emission;
+
+    // Кольцевые буферы на lagHops + 1 хопов
+    std::vector<int> backPointers;      // [slot][state]
+    std::vector<PitchCandidate> history; // [slot][MAX_CANDIDATES]
+    std::vector<int> historyCount;
+    std::vector<float> historyVoicing;
+    long long hopCount;
+};
+
+#endif // PITCHTRACKER_H
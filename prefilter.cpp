@@ -0,0 +1,144 @@
+#include "prefilter.h"
+#include "simdfloat.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double PI = 3.14159265358979323846;
+// Срез ФВЧ относительно нижней границы диапазона: ослабление там меньше 1 дБ
+const float HIGH_PASS_RANGE_FACTOR = 0.7f;
+}
+
+BiquadCoefficients BiquadCoefficients::identity()
+{
+    return {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+}
+
+BiquadCoefficients BiquadCoefficients::dcBlocker(float sampleRate, float cornerHz)
+{
+    // y[n] = x[n] - x[n-1] + R * y[n-1]
+    float r = float(1.0 - 2.0 * PI * cornerHz / sampleRate);
+    return {1.0f, -1.0f, 0.0f, -r, 0.0f};
+}
+
+BiquadCoefficients BiquadCoefficients::highPass(float sampleRate, float cutoffHz, float q)
+{
+    // Коэффициенты считаются в double: на низких частотах cos(w0) близок к 1
+    double w0 = 2.0 * PI * cutoffHz / sampleRate;
+    double cosW0 = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+
+    return {float((1.0 + cosW0) / 2.0 / a0),
+            float(-(1.0 + cosW0) / a0),
+            float((1.0 + cosW0) / 2.0 / a0),
+            float(-2.0 * cosW0 / a0),
+            float((1.0 - alpha) / a0)};
+}
+
+BiquadCoefficients BiquadCoefficients::notch(float sampleRate, float centerHz, float q)
+{
+    double w0 = 2.0 * PI * centerHz / sampleRate;
+    double cosW0 = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * q);
+    double a0 = 1.0 + alpha;
+
+    return {float(1.0 / a0),
+            float(-2.0 * cosW0 / a0),
+            float(1.0 / a0),
+            float(-2.0 * cosW0 / a0),
+            float((1.0 - alpha) / a0)};
+}
+
+PreFilter::PreFilter()
+    : sections(0)
+{
+}
+
+void PreFilter::configure(const Settings& settings, float sampleRate)
+{
+    groups.clear();
+    sections = 0;
+
+    if (!settings.enabled) return;
+
+    std::vector<BiquadCoefficients> cascade;
+    if (settings.dcBlocker) {
+        cascade.push_back(BiquadCoefficients::dcBlocker(sampleRate, 5.0f));
+    }
+    float highPassHz = settings.highPassHz;
+    if (settings.fundamentalMinHz > 0.0f) {
+        highPassHz = std::min(highPassHz, HIGH_PASS_RANGE_FACTOR * settings.fundamentalMinHz);
+    }
+    if (highPassHz > 0.0f) {
+        cascade.push_back(BiquadCoefficients::highPass(sampleRate, highPassHz, 0.7071f));
+    }
+    if (settings.mainsFrequency > 0.0f) {
+        for (int h = 1; h <= settings.mainsHarmonics; ++h) {
+            float center = settings.mainsFrequency * h;
+            if (center >= sampleRate / 2.0f) break;
+            // Режектор на основном тоне играемой ноты гасит её саму
+            if (center >= settings.fundamentalMinHz && center <= settings.fundamentalMaxHz) continue;
+            cascade.push_back(BiquadCoefficients::notch(sampleRate, center, settings.notchQ));
+        }
+    }
+
+    sections = int(cascade.size());
+
+    // Дополняем до кратного четырём тождественными секциями
+    while (cascade.size() % 4 != 0) {
+        cascade.push_back(BiquadCoefficients::identity());
+    }
+
+    groups.resize(cascade.size() / 4);
+    for (size_t g = 0; g < groups.size(); ++g) {
+        SectionGroup& group = groups[g];
+        for (int lane = 0; lane < 4; ++lane) {
+            const BiquadCoefficients& c = cascade[g * 4 + lane];
+            group.b0[lane] = c.b0;
+            group.b1[lane] = c.b1;
+            group.b2[lane] = c.b2;
+            group.a1[lane] = c.a1;
+            group.a2[lane] = c.a2;
+        }
+    }
+    reset();
+}
+
+void PreFilter::reset()
+{
+    for (SectionGroup& group : groups) {
+        for (int lane = 0; lane < 4; ++lane) {
+            group.z1[lane] = 0.0f;
+            group.z2[lane] = 0.0f;
+            group.out[lane] = 0.0f;
+        }
+    }
+}
+
+void PreFilter::process(float* data, int count)
+{
+    for (SectionGroup& group : groups) {
+        const SimdFloat4 b0 = SimdFloat4::load(group.b0);
+        const SimdFloat4 b1 = SimdFloat4::load(group.b1);
+        const SimdFloat4 b2 = SimdFloat4::load(group.b2);
+        const SimdFloat4 a1 = SimdFloat4::load(group.a1);
+        const SimdFloat4 a2 = SimdFloat4::load(group.a2);
+        SimdFloat4 z1 = SimdFloat4::load(group.z1);
+        SimdFloat4 z2 = SimdFloat4::load(group.z2);
+        SimdFloat4 y = SimdFloat4::load(group.out);
+
+        // Транспонированная прямая форма II, все четыре секции за шаг
+        for (int n = 0; n < count; ++n) {
+            SimdFloat4 x = y.shiftIn(data[n]);
+            y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            data[n] = y.lastLane();
+        }
+
+        z1.store(group.z1);
+        z2.store(group.z2);
+        y.store(group.out);
+    }
+}
@@ -0,0 +1,236 @@
+#include "processinggraph.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+const int DEFAULT_QUEUE_CAPACITY = 64;
+}
+
+struct ProcessingGraph::Node {
+    std::unique_ptr<ProcessingStage> stage;
+    Node* parent = nullptr;
+    std::vector<Node*> children;
+    int segment = -1;
+};
+
+struct ProcessingGraph::Segment {
+    explicit Segment(size_t capacity) : queue(capacity) {}
+
+    Node* entry = nullptr;
+    int totalCost = 0;
+    QStringList stageNames;
+    SpscQueue<AudioFrame> queue;
+    QSemaphore available;
+    QThread* thread = nullptr;
+    std::atomic<quint64> dropped{0};
+};
+
+ProcessingGraph::ProcessingGraph()
+    : threadCount(0),
+    queueCapacity(DEFAULT_QUEUE_CAPACITY),
+    threadStackSize(0),
+    running(false),
+    stopping(false)
+{
+}
+
+ProcessingGraph::~ProcessingGraph()
+{
+    stop();
+}
+
+ProcessingStage* ProcessingGraph::addStage(ProcessingStage* stage, ProcessingStage* after)
+{
+    if (running) {
+        qWarning() << "Cannot add stage" << stage->name() << "to a running processing graph.";
+        delete stage;
+        return nullptr;
+    }
+
+    std::unique_ptr<Node> node(new Node);
+    node->stage.reset(stage);
+
+    if (after) {
+        for (const std::unique_ptr<Node>& candidate : nodes) {
+            if (candidate->stage.get() == after) {
+                node->parent = candidate.get();
+                break;
+            }
+        }
+        if (!node->parent) {
+            qWarning() << "Stage" << stage->name() << "is attached to an unknown stage.";
+            return nullptr;
+        }
+        node->parent->children.push_back(node.get());
+    } else if (!nodes.empty()) {
+        qWarning() << "Processing graph already has a root stage.";
+        return nullptr;
+    }
+
+    nodes.push_back(std::move(node));
+    return stage;
+}
+
+ProcessingStage* ProcessingGraph::findStage(const QString& name) const
+{
+    for (const std::unique_ptr<Node>& node : nodes) {
+        if (node->stage->name() == name) return node->stage.get();
+    }
+    return nullptr;
+}
+
+void ProcessingGraph::schedule()
+{
+    segments.clear();
+    if (nodes.empty()) return;
+
+    int threads = threadCount > 0 ? threadCount : QThread::idealThreadCount();
+    threads = std::max(1, std::min(threads, int(nodes.size())));
+
+    int totalCost = 0;
+    for (const std::unique_ptr<Node>& node : nodes) {
+        totalCost += std::max(1, node->stage->cost());
+    }
+    const int budget = (totalCost + threads - 1) / threads;
+
+    // Узлы добавляются только после родителя, поэтому порядок nodes — топологический.
+    // Стадия остаётся в сегменте родителя, пока он не превысил бюджет.
+    for (const std::unique_ptr<Node>& node : nodes) {
+        const int cost = std::max(1, node->stage->cost());
+        Segment* parentSegment = node->parent ? segments[node->parent->segment].get() : nullptr;
+
+        if (!parentSegment || (parentSegment->totalCost + cost > budget && int(segments.size()) < threads)) {
+            std::unique_ptr<Segment> segment(new Segment(queueCapacity));
+            segment->entry = node.get();
+            segments.push_back(std::move(segment));
+            node->segment = int(segments.size()) - 1;
+        } else {
+            node->segment = node->parent->segment;
+        }
+
+        Segment* segment = segments[node->segment].get();
+        segment->totalCost += cost;
+        segment->stageNames << node->stage->name();
+    }
+}
+
+bool ProcessingGraph::start()
+{
+    if (running) return true;
+    if (nodes.empty()) return false;
+
+    for (const std::unique_ptr<Node>& node : nodes) {
+        node->stage->reset();
+    }
+
+    schedule();
+    stopping.store(false);
+
+    for (const std::unique_ptr<Segment>& segment : segments) {
+        Segment* raw = segment.get();
+        raw->thread = QThread::create([this, raw]() {
+            if (threadInitializer) threadInitializer();
+            workerLoop(raw);
+        });
+        raw->thread->setObjectName(QString("graph:%1").arg(raw->stageNames.join('>')));
+        if (threadStackSize > 0) raw->thread->setStackSize(threadStackSize);
+        raw->thread->start();
+    }
+
+    running = true;
+    qDebug() << "Processing graph started:" << plan();
+    return true;
+}
+
+void ProcessingGraph::stop()
+{
+    if (!running) return;
+
+    stopping.store(true);
+    for (const std::unique_ptr<Segment>& segment : segments) {
+        segment->available.release();
+    }
+    for (const std::unique_ptr<Segment>& segment : segments) {
+        segment->thread->wait();
+        delete segment->thread;
+        segment->thread = nullptr;
+    }
+
+    running = false;
+}
+
+bool ProcessingGraph::push(AudioFrame&& frame)
+{
+    if (!running) return false;
+
+    Segment* root = segments.front().get();
+    if (!root->queue.push(std::move(frame))) {
+        root->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    root->available.release();
+    return true;
+}
+
+void ProcessingGraph::workerLoop(Segment* segment)
+{
+    AudioFrame frame;
+    while (true) {
+        segment->available.acquire();
+        if (!segment->queue.pop(frame)) {
+            if (stopping.load()) break;
+            continue;
+        }
+        runNode(segment->entry, frame);
+    }
+}
+
+void ProcessingGraph::runNode(Node* node, AudioFrame& frame)
+{
+    if (frame.discontinuity) node->stage->reset();
+    if (!node->stage->process(frame)) return;
+
+    const size_t count = node->children.size();
+    for (size_t i = 0; i < count; ++i) {
+        // Последний потомок получает сам кадр, остальные — копии
+        if (i + 1 < count) {
+            AudioFrame copy = frame;
+            dispatch(node->children[i], copy, node->segment);
+        } else {
+            dispatch(node->children[i], frame, node->segment);
+        }
+    }
+}
+
+void ProcessingGraph::dispatch(Node* node, AudioFrame& frame, int fromSegment)
+{
+    if (node->segment == fromSegment) {
+        runNode(node, frame);
+        return;
+    }
+
+    Segment* target = segments[node->segment].get();
+    if (!target->queue.push(std::move(frame))) {
+        target->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    target->available.release();
+}
+
+quint64 ProcessingGraph::droppedFrames() const
+{
+    quint64 total = 0;
+    for (const std::unique_ptr<Segment>& segment : segments) {
+        total += segment->dropped.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+QStringList ProcessingGraph::plan() const
+{
+    QStringList result;
+    for (const std::unique_ptr<Segment>& segment : segments) {
+        result << QString("[%1] %2").arg(segment->totalCost).arg(segment->stageNames.join(" > "));
+    }
+    return result;
+}
@@ -0,0 +1,101 @@
+#ifndef PROCESSINGGRAPH_H
+#define PROCESSINGGRAPH_H
+
+#include <QAudioFormat>
+#include <QByteArray>
+#include <QSemaphore>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "spscqueue.h"
+#include "yinkernel.h"
+
+// Единица данных, которая проходит по графу: один хоп и всё, что о нём известно
+struct AudioFrame {
+    QByteArray raw;             // Данные устройства до ConverterStage
+    QAudioFormat format;
+    std::vector<float> samples; // Моно, float
+    float sampleRate = 0.0f;
+    quint64 hopIndex = 0;
+    float pitchHz = 0.0f;
+    float confidence = 0.0f;
+    int candidateCount = 0;
+    PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+    bool discontinuity = false; // Перед кадром был разрыв: стадии сбрасывают состояние
+};
+
+class ProcessingStage
+{
+public:
+    explicit ProcessingStage(const QString& name) : stageName(name) {}
+    virtual ~ProcessingStage() {}
+
+    // Возвращает false, если кадр не нужно передавать дальше
+    virtual bool process(AudioFrame& frame) = 0;
+    virtual void reset() {}
+    // Относительная стоимость стадии — по ней планировщик делит граф на потоки
+    virtual int cost() const { return 1; }
+
+    QString name() const { return stageName; }
+
+private:
+    QString stageName;
+};
+
+// Граф обработки: дерево стадий (у каждой стадии один вход, выходов сколько угодно).
+// При старте планировщик объединяет дешёвые соседние стадии в сегменты, и каждый
+// сегмент получает свой поток. Между сегментами кадры идут через ограниченные
+// SPSC-очереди; при переполнении кадр отбрасывается, источник никогда не ждёт.
+class ProcessingGraph
+{
+public:
+    ProcessingGraph();
+    ~ProcessingGraph();
+
+    // Добавляет стадию после after (nullptr — корень графа). Граф владеет стадией.
+    ProcessingStage* addStage(ProcessingStage* stage, ProcessingStage* after = nullptr);
+    ProcessingStage* findStage(const QString& name) const;
+
+    // 0 — по числу ядер
+    void setThreadCount(int threads) { threadCount = threads; }
+    void setQueueCapacity(int frames) { queueCapacity = frames; }
+    // 0 — размер стека QThread по умолчанию
+    void setThreadStackSize(uint bytes) { threadStackSize = bytes; }
+    // Вызывается в каждом рабочем потоке перед первым кадром (приоритет, привязка к ядрам)
+    void setThreadInitializer(std::function<void()> initializer) { threadInitializer = std::move(initializer); }
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running; }
+
+    // Подаёт кадр в корень; вызывается из одного потока-источника
+    bool push(AudioFrame&& frame);
+
+    quint64 droppedFrames() const;
+    // Разбиение по потокам, для журнала
+    QStringList plan() const;
+
+private:
+    struct Node;
+    struct Segment;
+
+    void schedule();
+    void workerLoop(Segment* segment);
+    void runNode(Node* node, AudioFrame& frame);
+    void dispatch(Node* node, AudioFrame& frame, int fromSegment);
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    std::vector<std::unique_ptr<Segment>> segments;
+    int threadCount;
+    int queueCapacity;
+    uint threadStackSize;
+    std::function<void()> threadInitializer;
+    bool running;
+    std::atomic<bool> stopping;
+};
+
+#endif // PROCESSINGGRAPH_H
@@ -1,5 +1,6 @@
 
 #include "qtaudiorecorder.h"
+#include "graphstages.h"
 #include <QDebug>
 #include <QMessageBox>
 
@@ -24,43 +25,202 @@ QtAudioRecorder::QtAudioRecorder(QObject *parent)
     audioInputDevice(nullptr),
     pitchDetector(nullptr),
     processingThread(nullptr),
-    running(false)
+    running(false),
+    startPending(false),
+    mediaDevices(nullptr),
+    deviceSwitchPending(false),
+    graphEnabled(false),
+    graphThreads(0),
+    graph(nullptr),
+    hopCounter(0),
+    pitchStreamEnabled(false),
+    trackingEnabled(true),
+    decimationEnabled(false),
+    profile(InstrumentProfile::find("guitar")),
+    hopFrames(profile.hopSize),
+    contourHop(0),
+    partialsWorker(nullptr),
+    partialsThread(nullptr),
+    graphDiscontinuity(false),
+    noiseCalibrating(false)
 {
-    QAudioFormat format;
-    format.setSampleRate(QT_SAMPLE_RATE);
-    format.setChannelCount(QT_CHANNEL_COUNT);
-    format.setSampleFormat(QAudioFormat::Float);
+    // Устройство и детектор создаются позже, в initialize() и startRecording(),
+    // чтобы конструктор окна не ждал аудиоподсистему
+    processingThread = new QThread(this);
+    connect(processingThread, &QThread::started, this, &QtAudioRecorder::handleProcessingThreadStarted);
+
+    // Список устройств при подключении меняется несколько раз подряд
+    deviceCheckTimer.setSingleShot(true);
+    deviceCheckTimer.setInterval(50);
+    connect(&deviceCheckTimer, &QTimer::timeout, this, &QtAudioRecorder::checkAudioDevice);
+}
 
+QtAudioRecorder::DeviceProbe QtAudioRecorder::probeDefaultDevice()
+{
+    DeviceProbe probe;
+    probe.format.setSampleRate(QT_SAMPLE_RATE);
+    probe.format.setChannelCount(QT_CHANNEL_COUNT);
+    probe.format.setSampleFormat(QAudioFormat::Float);
 
-    QAudioDevice info = QMediaDevices::defaultAudioInput();
+    probe.device = QMediaDevices::defaultAudioInput();
 
-    if (info.isNull() || info.description().isEmpty()) {
+    if (probe.device.isNull() || probe.device.description().isEmpty()) {
         qCritical() << "No default audio input device found or it is invalid.";
-        emit errorOccurred("No default audio input device found. Please check your microphone.");
+        probe.error = "No default audio input device found. Please check your microphone.";
+        return probe;
+    }
+
+    if (!probe.device.isFormatSupported(probe.format)) {
+        qCritical() << "Default input device does not support requested format (Float 48kHz mono).";
+        probe.error = "Microphone does not support required audio format (Float 48kHz mono).";
+    }
+    return probe;
+}
+
+void QtAudioRecorder::initialize()
+{
+    if (audioSource) return;
+
+    // QMediaDevices и QAudioDevice не потокобезопасны, а первое обращение
+    // поднимает медиабэкенд — всё это только в потоке GUI. Окно к этому
+    // моменту уже создано: initialize() вызывается из цикла событий
+    if (!mediaDevices) {
+        // Следим за списком входов при любом исходе поиска: если при запуске
+        // микрофона нет, он найдётся при подключении
+        mediaDevices = new QMediaDevices(this);
+        connect(mediaDevices, &QMediaDevices::audioInputsChanged,
+                &deviceCheckTimer, qOverload<>(&QTimer::start));
+    }
+
+    const DeviceProbe probe = probeDefaultDevice();
+    if (!probe.error.isEmpty()) {
+        // Запуск по кнопке сообщает всегда, повторный поиск по списку — только новую ошибку
+        const bool report = startPending || probe.error != lastProbeError;
+        startPending = false;
+        lastProbeError = probe.error;
+        if (report) emit errorOccurred(probe.error);
         return;
     }
+    lastProbeError.clear();
 
-    if (!info.isFormatSupported(format)) {
-        qCritical() << "Default input device does not support requested format (Float 44.1kHz mono).";
-        emit errorOccurred("Microphone does not support required audio format (Float 44.1kHz mono).");
+    captureFormat = probe.format;
+    if (!createAudioSource(probe.device)) {
+        // Список успел измениться между поиском и созданием — ждём следующего
+        deviceCheckTimer.start();
         return;
     }
+    qDebug() << "Audio input ready:" << probe.device.description();
+    emit deviceReady(probe.device.description());
 
-    audioSource = new QAudioSource(info, format, this);
+    if (startPending) {
+        startPending = false;
+        startRecording();
+    }
+}
 
-    pitchDetector = new PitchDetector(format.sampleRate(), QT_BUFFER_SIZE_FRAMES * 4, QT_BUFFER_SIZE_FRAMES);
-    processingThread = new QThread(this);
-    pitchDetector->moveToThread(processingThread);
+bool QtAudioRecorder::createAudioSource(const QAudioDevice& device)
+{
+    if (!device.isFormatSupported(captureFormat)) {
+        qWarning() << "Audio input" << device.description() << "does not support the capture format.";
+        return false;
+    }
 
-    connect(pitchDetector, &PitchDetector::pitchDetected, this, &QtAudioRecorder::handlePitchDetection, Qt::QueuedConnection);
-    connect(processingThread, &QThread::started, this, &QtAudioRecorder::handleProcessingThreadStarted);
-    connect(processingThread, &QThread::finished, pitchDetector, &QObject::deleteLater);
+    audioSource = new QAudioSource(device, captureFormat, this);
+    connect(audioSource, &QAudioSource::stateChanged,
+            this, &QtAudioRecorder::handleAudioSourceStateChanged);
+    currentDevice = device;
+    return true;
+}
+
+void QtAudioRecorder::handleAudioSourceStateChanged(QAudio::State state)
+{
+    // Отключённое устройство обычно проявляется как IOError ещё до обновления списка
+    if (state == QAudio::StoppedState && running && audioSource && audioSource->error() != QAudio::NoError) {
+        qWarning() << "Audio input stopped with error" << audioSource->error();
+        deviceCheckTimer.start();
+    }
+}
+
+void QtAudioRecorder::checkAudioDevice()
+{
+    if (!mediaDevices) return;
+
+    // Устройство ещё ни разу не открывалось (при запуске микрофона не было) —
+    // формат не проверен, поэтому ищем заново тем же путём, что и при запуске
+    if (!captureFormat.isValid()) {
+        if (!QMediaDevices::defaultAudioInput().isNull()) initialize();
+        return;
+    }
+
+    const QAudioDevice defaultDevice = QMediaDevices::defaultAudioInput();
+    const bool currentPresent = audioSource && QMediaDevices::audioInputs().contains(currentDevice);
+    const bool currentFailed = !audioSource || audioSource->error() != QAudio::NoError;
+
+    if (currentPresent && !currentFailed && defaultDevice == currentDevice) return;
+
+    if (defaultDevice.isNull()) {
+        if (!currentPresent) {
+            qWarning() << "Audio input lost, waiting for a device to appear.";
+            emit deviceLost();
+        }
+        return;
+    }
+
+    switchAudioDevice(defaultDevice);
+}
+
+void QtAudioRecorder::switchAudioDevice(const QAudioDevice& device)
+{
+    qDebug() << "Switching audio input to" << device.description();
+
+    if (audioInputDevice) {
+        disconnect(audioInputDevice, &QIODevice::readyRead,
+                   this, &QtAudioRecorder::readMoreAudioData);
+        audioInputDevice = nullptr;
+    }
+
+    if (audioSource) {
+        QAudioSource *oldSource = audioSource;
+        audioSource = nullptr;
+        oldSource->disconnect(this);
+        oldSource->stop();
+        oldSource->deleteLater();
+    }
+
+    // Неполный кадр от старого устройства не склеиваем с новым потоком
+    audioDataBuffer.clear();
+
+    // Без устройства запись не должна выглядеть идущей: останавливаемся,
+    // окно по errorOccurred возвращает кнопку в исходное состояние
+    if (!createAudioSource(device)) {
+        stopRecording();
+        emit errorOccurred(QString("Audio input %1 does not support the required audio format (Float 48kHz mono). "
+                                   "Recording stopped.").arg(device.description()));
+        return;
+    }
+
+    // Поток обработки и детектор не трогаем — они продолжают работать с прежним состоянием
+    if (running) {
+        audioInputDevice = audioSource->start();
+        if (!audioInputDevice) {
+            stopRecording();
+            emit errorOccurred("Failed to start audio input. Recording stopped.");
+            return;
+        }
+        connect(audioInputDevice, &QIODevice::readyRead,
+                this, &QtAudioRecorder::readMoreAudioData);
+        deviceSwitchPending = true;
+    } else {
+        emit deviceSwitched(device.description(), 0);
+    }
 }
 
 QtAudioRecorder::~QtAudioRecorder()
 {
     stopRecording();
     cleanupPitchDetector();
+    setPartialsAnalysisEnabled(false);
+    delete graph;
 
     if (processingThread) {
         delete processingThread;
@@ -75,19 +235,32 @@ void QtAudioRecorder::startRecording()
 {
     if (running) return;
 
-    cleanupPitchDetector();
-
-    pitchDetector = new PitchDetector(audioSource->format().sampleRate(),
-                                      QT_BUFFER_SIZE_FRAMES * 4,
-                                      QT_BUFFER_SIZE_FRAMES);
-    pitchDetector->moveToThread(processingThread);
+    if (!audioSource) {
+        // Устройство ещё не найдено — ищем сейчас и стартуем, если оно есть
+        startPending = true;
+        initialize();
+        return;
+    }
 
-    connect(pitchDetector, &PitchDetector::pitchDetected,
-            this, &QtAudioRecorder::handlePitchDetection,
-            Qt::QueuedConnection);
+    cleanupPitchDetector();
+    hopFrames = profile.hopSize;
+    idleMonitor.configure(idleSettings, audioSource->format().sampleRate(), hopFrames);
 
-    processingThread->start();
+    if (graphEnabled) {
+        startProcessingGraph();
+    } else {
+        startPitchDetector();
+    }
 
+    // Потоки и буферы анализа уже созданы — фиксируем их (MCL_CURRENT);
+    // при каждом старте заново, потому что смена профиля пересоздаёт буферы
+    if (realtimeSettings.lockMemory) {
+        QStringList problems = RealtimeSupport::lockProcessMemory();
+        if (!problems.isEmpty()) {
+            qWarning() << "Could not lock memory:" << problems;
+            emit realtimeStatus(QString("Не удалось зафиксировать память: %1").arg(problems.join("; ")));
+        }
+    }
 
     audioDataBuffer.clear();
     audioInputDevice = audioSource->start();
@@ -96,36 +269,282 @@ void QtAudioRecorder::startRecording()
         connect(audioInputDevice, &QIODevice::readyRead,
                 this, &QtAudioRecorder::readMoreAudioData);
         running = true;
+        deviceSwitchPending = false;
+        sinceLastAudio.start();
         qDebug() << "Audio recording started.";
     } else {
         emit errorOccurred("Failed to start audio input.");
         cleanupPitchDetector();
+        if (graph) graph->stop();
     }
 }
 
+void QtAudioRecorder::startPitchDetector()
+{
+    pitchDetector = new PitchDetector(audioSource->format().sampleRate(),
+                                      profile.windowSize,
+                                      profile.hopSize);
+    pitchDetector->setPreFilterSettings(preFilterSettings);
+    pitchDetector->setFrequencyRange(profile.minFrequency, profile.maxFrequency);
+    pitchDetector->setTrackingEnabled(trackingEnabled && profile.tracking);
+    if (decimationEnabled) {
+        int factor = PolyphaseDecimator::factorForRange(audioSource->format().sampleRate(),
+                                                        profile.maxFrequency,
+                                                        profile.hopSize);
+        pitchDetector->setDecimationFactor(factor);
+        qDebug() << "Pitch analysis decimated by" << factor;
+    }
+    pitchDetector->setContourHop(contourHop);
+    pitchDetector->moveToThread(processingThread);
+
+    // Настройка выполняется в самом потоке обработки, до первого хопа
+    connect(processingThread, &QThread::started, pitchDetector, [this]() {
+        configureAnalysisThread("detector");
+    }, Qt::DirectConnection);
+
+    connect(pitchDetector, &PitchDetector::pitchDetected,
+            this, &QtAudioRecorder::handlePitchDetection,
+            Qt::QueuedConnection);
+    connect(pitchDetector, &PitchDetector::pitchContour,
+            this, &QtAudioRecorder::pitchContour,
+            Qt::QueuedConnection);
+    connect(pitchDetector, &PitchDetector::noiseCalibrationFinished,
+            this, &QtAudioRecorder::finishNoiseCalibration,
+            Qt::QueuedConnection);
+
+    // Профиль с прошлого запуска; при другом окне анализа он уже не годится
+    if (!noiseProfile.isEmpty() && !pitchDetector->setNoiseProfile(noiseProfile)) {
+        noiseProfile.clear();
+    }
+
+    const bool contour = pitchDetector->contourHop() > 0;
+    const int publishedHop = contour ? pitchDetector->contourHop() : hopFrames;
+    if (pitchStreamEnabled && pitchStreamPublisher.open(audioSource->format().sampleRate(), publishedHop)) {
+        // Публикуем прямо в потоке обработки, минуя очередь событий GUI
+        PitchDetector *detector = pitchDetector;
+        if (contour) {
+            connect(pitchDetector, &PitchDetector::pitchContour, this,
+                    [this](const QVector<float>& pitches, const QVector<float>& confidences) {
+                for (int i = 0; i < pitches.size(); ++i) {
+                    pitchStreamPublisher.publish(pitches[i], confidences[i]);
+                }
+            }, Qt::DirectConnection);
+        } else {
+            connect(pitchDetector, &PitchDetector::pitchDetected, this, [this, detector](float pitchHz) {
+                pitchStreamPublisher.publish(pitchHz, detector->confidence());
+            }, Qt::DirectConnection);
+        }
+    }
+
+    processingThread->setStackSize(realtimeSettings.lockMemory ? RealtimeSupport::ANALYSIS_STACK_BYTES : 0);
+    processingThread->start();
+}
+
+void QtAudioRecorder::startProcessingGraph()
+{
+    if (contourHop > 0) {
+        qWarning() << "Pitch contour is not available in the stage graph, ignoring contour hop";
+    }
+    if (pitchStreamEnabled) {
+        pitchStreamPublisher.open(audioSource->format().sampleRate(), hopFrames);
+    }
+    hopCounter = 0;
+    processingGraph()->setThreadInitializer([this]() {
+        configureAnalysisThread(QThread::currentThread()->objectName());
+    });
+    processingGraph()->setThreadStackSize(realtimeSettings.lockMemory ? RealtimeSupport::ANALYSIS_STACK_BYTES : 0);
+    processingGraph()->start();
+}
+
 void QtAudioRecorder::stopRecording()
 {
+    startPending = false;
     if (!running) return;
 
     running = false;
 
+    if (idleMonitor.isIdle()) {
+        idleMonitor.reset();
+        emit idleStateChanged(false);
+    }
+
     if (audioInputDevice) {
         disconnect(audioInputDevice, &QIODevice::readyRead,
                    this, &QtAudioRecorder::readMoreAudioData);
         audioInputDevice = nullptr;
     }
 
-    audioSource->stop();
+    if (audioSource) {
+        audioSource->stop();
+    }
 
     // Очищаем буфер
     audioDataBuffer.clear();
 
+    if (partialsWorker) {
+        QMetaObject::invokeMethod(partialsWorker, &PartialsWorker::reset, Qt::QueuedConnection);
+    }
+
     // Останавливаем и очищаем pitchDetector
     cleanupPitchDetector();
+    if (graph) {
+        graph->stop();
+    }
+
+    pitchStreamPublisher.close();
 
     qDebug() << "Audio recording stopped.";
 }
 
+void QtAudioRecorder::configureAnalysisThread(const QString& threadName)
+{
+    // Вызывается из потока анализа; сигнал доставляется в GUI через очередь
+    QStringList problems = RealtimeSupport::configureCurrentThread(realtimeSettings);
+    if (!problems.isEmpty()) {
+        qWarning() << "Thread" << threadName << "realtime setup incomplete:" << problems;
+        emit realtimeStatus(QString("Поток %1: %2").arg(threadName, problems.join("; ")));
+    }
+}
+
+void QtAudioRecorder::calibrateNoise(float seconds)
+{
+    if (noiseCalibrating) return;
+
+    // После неудачного переключения устройства audioSource может отсутствовать
+    if (!running || !audioSource || !pitchDetector || !pitchDetector->isNoiseReductionAvailable()) {
+        qWarning() << "Noise calibration needs a running input and detector with tracking and without contour";
+        emit noiseCalibrationFinished(false);
+        return;
+    }
+
+    const int hops = qMax(1, qRound(seconds * audioSource->format().sampleRate() / hopFrames));
+    noiseCalibrating = true;
+    QMetaObject::invokeMethod(pitchDetector, "startNoiseCalibration", Qt::QueuedConnection,
+                              Q_ARG(int, hops));
+    qDebug() << "Noise calibration started for" << hops << "hops";
+}
+
+void QtAudioRecorder::finishNoiseCalibration(const QVector<float>& powerSpectrum)
+{
+    noiseCalibrating = false;
+    if (!powerSpectrum.isEmpty()) noiseProfile = powerSpectrum;
+    emit noiseCalibrationFinished(!powerSpectrum.isEmpty());
+}
+
+void QtAudioRecorder::clearNoiseProfile()
+{
+    noiseProfile.clear();
+    if (pitchDetector) {
+        QMetaObject::invokeMethod(pitchDetector, "clearNoiseProfile", Qt::QueuedConnection);
+    }
+}
+
+void QtAudioRecorder::setPartialsAnalysisEnabled(bool enabled)
+{
+    if (enabled == (partialsWorker != nullptr)) return;
+
+    if (enabled) {
+        partialsThread = new QThread(this);
+        partialsWorker = new PartialsWorker();
+        partialsWorker->setLowestFrequency(profile.minFrequency);
+        partialsWorker->moveToThread(partialsThread);
+        connect(partialsThread, &QThread::finished, partialsWorker, &QObject::deleteLater);
+        connect(partialsWorker, &PartialsWorker::partialsAnalyzed,
+                this, &QtAudioRecorder::partialsAnalyzed, Qt::QueuedConnection);
+        // Подсказка основного тона — результат основного детектора
+        connect(this, &QtAudioRecorder::pitchDetected,
+                partialsWorker, &PartialsWorker::setFundamentalHint, Qt::QueuedConnection);
+        if (realtimeSettings.lockMemory) {
+            partialsThread->setStackSize(RealtimeSupport::ANALYSIS_STACK_BYTES);
+        }
+        partialsThread->start(QThread::LowPriority);
+        qDebug() << "Partials analysis started.";
+    } else {
+        disconnect(partialsWorker, nullptr, this, nullptr);
+        disconnect(this, nullptr, partialsWorker, nullptr);
+        partialsWorker = nullptr;
+        partialsThread->quit();
+        partialsThread->wait();
+        delete partialsThread;
+        partialsThread = nullptr;
+        qDebug() << "Partials analysis stopped.";
+    }
+}
+
+void QtAudioRecorder::setInstrumentProfile(const InstrumentProfile& newProfile)
+{
+    const bool restart = running;
+    if (restart) stopRecording();
+
+    profile = newProfile;
+    qDebug() << "Instrument profile" << profile.id << profile.minFrequency << "-" << profile.maxFrequency
+             << "Hz, window" << profile.windowSize << "hop" << profile.hopSize;
+
+    if (partialsWorker) {
+        QMetaObject::invokeMethod(partialsWorker, "setLowestFrequency", Qt::QueuedConnection,
+                                  Q_ARG(float, profile.minFrequency));
+    }
+
+    // Граф по умолчанию собран под прежний диапазон и окно
+    if (graph) {
+        delete graph;
+        graph = nullptr;
+    }
+
+    if (restart) startRecording();
+}
+
+void QtAudioRecorder::setProcessingGraphEnabled(bool enabled, int threads)
+{
+    graphEnabled = enabled;
+    graphThreads = threads;
+    if (graph) {
+        graph->setThreadCount(threads);
+    }
+}
+
+ProcessingGraph* QtAudioRecorder::processingGraph()
+{
+    if (graph) return graph;
+
+    graph = new ProcessingGraph();
+    graph->setThreadCount(graphThreads);
+
+    ProcessingStage* last = graph->addStage(new ConverterStage());
+    last = graph->addStage(new PreFilterStage(preFilterSettings.forRange(profile.minFrequency,
+                                                                         profile.maxFrequency)), last);
+    if (decimationEnabled) {
+        int factor = PolyphaseDecimator::factorForRange(QT_SAMPLE_RATE, profile.maxFrequency, profile.hopSize);
+        last = graph->addStage(new DecimatorStage(factor), last);
+    }
+    // Длительность окна — как у PitchDetector
+    last = graph->addStage(new DetectorStage(profile.windowSize / float(QT_SAMPLE_RATE),
+                                             profile.minFrequency, profile.maxFrequency), last);
+    if (trackingEnabled && profile.tracking) {
+        PitchTracker::Settings trackerSettings;
+        trackerSettings.minFrequency = profile.minFrequency;
+        trackerSettings.maxFrequency = profile.maxFrequency;
+        last = graph->addStage(new TrackerStage(trackerSettings), last);
+    }
+
+    // Результат уходит в GUI-поток и, если включено, в разделяемую память прямо из потока графа
+    graph->addStage(new SinkStage("output", [this](const AudioFrame& frame) {
+        pitchStreamPublisher.publish(frame.pitchHz, frame.confidence);
+        QMetaObject::invokeMethod(this, "handlePitchDetection", Qt::QueuedConnection,
+                                  Q_ARG(float, frame.pitchHz));
+    }), last);
+
+    return graph;
+}
+
+void QtAudioRecorder::setPitchStreamEnabled(bool enabled)
+{
+    pitchStreamEnabled = enabled;
+    if (!enabled) {
+        pitchStreamPublisher.close();
+    }
+}
+
 void QtAudioRecorder::cleanupPitchDetector()
 {
     // Отключаем все соединения
@@ -150,6 +569,12 @@ void QtAudioRecorder::cleanupPitchDetector()
         delete pitchDetector;
         pitchDetector = nullptr;
     }
+
+    // Незаконченная калибровка пропадает вместе с детектором
+    if (noiseCalibrating) {
+        noiseCalibrating = false;
+        emit noiseCalibrationFinished(false);
+    }
 }
 
 
@@ -160,6 +585,14 @@ void QtAudioRecorder::readMoreAudioData()
     QByteArray newAudioData = audioInputDevice->readAll();
     audioDataBuffer.append(newAudioData);
 
+    if (deviceSwitchPending && !newAudioData.isEmpty()) {
+        deviceSwitchPending = false;
+        qint64 downtime = sinceLastAudio.elapsed();
+        qDebug() << "Audio input switched, downtime" << downtime << "ms";
+        emit deviceSwitched(currentDevice.description(), downtime);
+    }
+    sinceLastAudio.start();
+
     int sampleSize = getSampleSizeInBytes(audioSource->format().sampleFormat());
     if (sampleSize == 0) {
         qCritical() << "Unsupported sample format detected during read. Stopping audio.";
@@ -169,15 +602,62 @@ void QtAudioRecorder::readMoreAudioData()
     }
     int frameSize = sampleSize * audioSource->format().channelCount();
 
-    while (audioDataBuffer.size() >= QT_BUFFER_SIZE_FRAMES * frameSize) {
-        QByteArray chunk = audioDataBuffer.mid(0, QT_BUFFER_SIZE_FRAMES * frameSize);
-        audioDataBuffer.remove(0, QT_BUFFER_SIZE_FRAMES * frameSize);
+    const int hopBytes = hopFrames * frameSize;
+    int consumed = 0;
+    for (; audioDataBuffer.size() - consumed >= hopBytes; consumed += hopBytes) {
+        // В простое хоп проверяется только по энергии и дальше не идёт;
+        // такие хопы не копируются, буфер сдвигается один раз в конце
+        bool idleChanged = false;
+        const bool analyze = idleMonitor.update(audioDataBuffer.constData() + consumed, hopFrames,
+                                                audioSource->format(), idleChanged);
+        if (idleChanged) {
+            qDebug() << (idleMonitor.isIdle() ? "Entering idle mode" : "Leaving idle mode")
+                     << "at" << idleMonitor.lastLevelDb() << "dBFS";
+            if (!idleMonitor.isIdle()) resetAnalysisState();
+            emit idleStateChanged(idleMonitor.isIdle());
+        }
+        // Калибровке шума нужны именно тихие хопы
+        if (!analyze && !noiseCalibrating) continue;
+
+        QByteArray chunk = audioDataBuffer.mid(consumed, hopBytes);
+
+        if (partialsWorker) {
+            // Копия хопа неявно разделяемая; преобразование формата — в потоке анализа
+            PartialsWorker *worker = partialsWorker;
+            QAudioFormat format = audioSource->format();
+            QMetaObject::invokeMethod(partialsWorker, [worker, chunk, format]() {
+                worker->processHop(chunk, format);
+            }, Qt::QueuedConnection);
+        }
+
+        if (graph && graph->isRunning()) {
+            // Граф сам преобразует формат; при переполнении кадр отбрасывается, а не ждёт
+            AudioFrame frame;
+            frame.raw = chunk;
+            frame.format = audioSource->format();
+            frame.hopIndex = hopCounter++;
+            frame.discontinuity = graphDiscontinuity;
+            graphDiscontinuity = false;
+            graph->push(std::move(frame));
+            continue;
+        }
 
         const float* audioFloats = reinterpret_cast<const float*>(chunk.constData());
 
         QMetaObject::invokeMethod(pitchDetector, "processAudio", Qt::QueuedConnection,
                                   Q_ARG(const float*, audioFloats));
     }
+    audioDataBuffer.remove(0, consumed);
+}
+
+void QtAudioRecorder::resetAnalysisState()
+{
+    // Окно и трекер помнят кадры до паузы — первые решения были бы по ним.
+    // Сброс встаёт в очередь раньше первого хопа после простоя.
+    if (pitchDetector) {
+        QMetaObject::invokeMethod(pitchDetector, "resetState", Qt::QueuedConnection);
+    }
+    graphDiscontinuity = true;
 }
 
 void QtAudioRecorder::handlePitchDetection(float pitchHz)
@@ -9,14 +9,20 @@
 
 #include <QAudioSource>
 #include <QMediaDevices>
+#include <QElapsedTimer>
+#include <QTimer>
 
+#include "idlemonitor.h"
+#include "instrumentprofile.h"
+#include "partialsworker.h"
+#include "realtimesupport.h"
 #include "pitchdetector.h"
+#include "pitchstreampublisher.h"
+#include "processinggraph.h"
 
 const int QT_SAMPLE_RATE = 48000;
 const int QT_CHANNEL_COUNT = 1;
 
-const int QT_BUFFER_SIZE_FRAMES = 512;
-
 class QtAudioRecorder : public QObject
 {
     Q_OBJECT
@@ -24,18 +30,90 @@ public:
     explicit QtAudioRecorder(QObject *parent = nullptr);
     ~QtAudioRecorder();
 
+    // Публикация результатов в разделяемую память для других процессов
+    void setPitchStreamEnabled(bool enabled);
+    bool isPitchStreamEnabled() const { return pitchStreamEnabled; }
+
+    // Настройки каскада фильтров перед детектором (применяются при следующем старте)
+    void setPreFilterSettings(const PreFilter::Settings& settings) { preFilterSettings = settings; }
+    PreFilter::Settings getPreFilterSettings() const { return preFilterSettings; }
+
+    // HMM-трекинг вместо одиночного кандидата aubio (применяется при следующем старте)
+    void setTrackingEnabled(bool enabled) { trackingEnabled = enabled; }
+    bool isTrackingEnabled() const { return trackingEnabled; }
+
+    // Децимация перед детектором; коэффициент выбирается по верхней частоте инструмента
+    void setDecimationEnabled(bool enabled) { decimationEnabled = enabled; }
+
+    // Профиль инструмента: диапазон частот, окно, хоп и движок детектора.
+    // Во время записи детектор перезапускается; граф стадий строится заново.
+    void setInstrumentProfile(const InstrumentProfile& profile);
+    InstrumentProfile instrumentProfile() const { return profile; }
+
+    // Плотный контур питча каждые samples входных отсчётов (0 — выкл., применяется при следующем старте).
+    // При включённом --pitch-stream публикуются точки контура, а не значения по хопам.
+    void setContourHop(int samples) { contourHop = samples; }
+    int getContourHop() const { return contourHop; }
+
+    // Экономичный режим: после продолжительной тишины хопы не анализируются
+    // и интерфейс не обновляется (применяется при следующем старте)
+    void setIdleSettings(const IdleMonitor::Settings& settings) { idleSettings = settings; }
+    IdleMonitor::Settings getIdleSettings() const { return idleSettings; }
+    bool isIdle() const { return idleMonitor.isIdle(); }
+
+    // Приоритет реального времени, привязка к ядрам и фиксация памяти для потоков
+    // анализа (применяется при следующем старте). Что не удалось — в realtimeStatus().
+    void setRealtimeSettings(const RealtimeSupport::Settings& settings) { realtimeSettings = settings; }
+    RealtimeSupport::Settings getRealtimeSettings() const { return realtimeSettings; }
+
+    // Анализ партиалов и негармоничности в отдельном потоке (можно включать во время записи)
+    void setPartialsAnalysisEnabled(bool enabled);
+    bool isPartialsAnalysisEnabled() const { return partialsWorker != nullptr; }
+
+    // Профиль фонового шума: seconds секунд записи без игры усредняются в спектр шума,
+    // который затем вычитается перед детектором. Нужна запись с трекингом, без графа и контура.
+    // Профиль хранится здесь и переживает перезапуск, пока не меняется окно анализа.
+    void calibrateNoise(float seconds = 2.0f);
+    void clearNoiseProfile();
+    bool hasNoiseProfile() const { return !noiseProfile.isEmpty(); }
+    bool isCalibratingNoise() const { return noiseCalibrating; }
+
+    bool isDeviceReady() const { return audioSource != nullptr; }
+
+    // Обработка через граф стадий вместо одного PitchDetector.
+    // threads: 0 — по числу ядер. Граф строится при первом обращении по текущим настройкам.
+    void setProcessingGraphEnabled(bool enabled, int threads = 0);
+    // Граф по умолчанию: converter > prefilter > decimator > detector > tracker > sink.
+    // Дополнительные стадии можно подвесить к любой из них до старта записи.
+    ProcessingGraph* processingGraph();
+
 public slots:
+    // Ищет микрофон и проверяет формат в потоке GUI; вызывается из цикла событий после создания окна
+    void initialize();
     void startRecording();
     void stopRecording();
 
 signals:
     void pitchDetected(float pitchHz);
+    void pitchContour(const QVector<float>& pitches, const QVector<float>& confidences);
     void errorOccurred(const QString& message);
+    void deviceReady(const QString& description);
+    // Переключение на другой вход без пересоздания детектора; downtimeMs — разрыв в звуке
+    void deviceSwitched(const QString& description, qint64 downtimeMs);
+    void deviceLost();
+    // Переход в простой (idle == true) и возврат к полному анализу
+    void idleStateChanged(bool idle);
+    void partialsAnalyzed(const PartialsResult& result);
+    // Сообщение о привилегиях, которые не удалось получить (может приходить из потоков анализа)
+    void realtimeStatus(const QString& message);
+    void noiseCalibrationFinished(bool success);
 
 private slots:
     void readMoreAudioData(); // Слот для чтения данных из QAudioSource
     void handlePitchDetection(float pitchHz); // Слот для получения питча от PitchDetector
     void handleProcessingThreadStarted(); // Слот, вызываемый при старте потока обработки
+    void checkAudioDevice();
+    void handleAudioSourceStateChanged(QAudio::State state);
 
 private:
     QAudioSource *audioSource;
@@ -46,7 +124,58 @@ private:
     bool running;
 
     QByteArray audioDataBuffer;
+    void startPitchDetector();
+    void startProcessingGraph();
     void cleanupPitchDetector();
+    void configureAnalysisThread(const QString& threadName);
+    void finishNoiseCalibration(const QVector<float>& powerSpectrum);
+    void resetAnalysisState();
+
+    struct DeviceProbe {
+        QAudioDevice device;
+        QAudioFormat format;
+        QString error;
+    };
+    static DeviceProbe probeDefaultDevice();
+    bool startPending;
+    QString lastProbeError; // Повторный поиск с той же ошибкой не сообщается снова
+
+    // Горячее подключение: следим за списком входов и меняем только QAudioSource
+    bool createAudioSource(const QAudioDevice& device);
+    void switchAudioDevice(const QAudioDevice& device);
+    QMediaDevices *mediaDevices;
+    QTimer deviceCheckTimer;
+    QAudioDevice currentDevice;
+    QAudioFormat captureFormat;
+    QElapsedTimer sinceLastAudio;
+    bool deviceSwitchPending;
+
+    bool graphEnabled;
+    int graphThreads;
+    ProcessingGraph *graph;
+    quint64 hopCounter;
+
+    bool pitchStreamEnabled;
+    PitchStreamPublisher pitchStreamPublisher;
+
+    PreFilter::Settings preFilterSettings;
+    bool trackingEnabled;
+    bool decimationEnabled;
+    InstrumentProfile profile;
+    int hopFrames;
+    int contourHop;
+
+    PartialsWorker *partialsWorker;
+    QThread *partialsThread;
+
+    RealtimeSupport::Settings realtimeSettings;
+
+    IdleMonitor::Settings idleSettings;
+    IdleMonitor idleMonitor;
+    bool graphDiscontinuity;
+
+    QVector<float> noiseProfile;
+    bool noiseCalibrating;
 
 };
 
@@ -0,0 +1,164 @@
+#include "realtimesupport.h"
+#include <QThread>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define TUNER_HAS_MXCSR 1
+#endif
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#endif
+
+namespace {
+// Меньше размера стека QThread по умолчанию
+const int STACK_PREFAULT_BYTES = 128 * 1024;
+
+#ifdef Q_OS_LINUX
+// Размер адресного пространства процесса (первое поле /proc/self/statm, в страницах)
+quint64 mappedBytes()
+{
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    unsigned long long pages = 0;
+    if (std::fscanf(statm, "%llu", &pages) != 1) pages = 0;
+    std::fclose(statm);
+    return quint64(pages) * quint64(sysconf(_SC_PAGESIZE));
+}
+#endif
+}
+
+void RealtimeSupport::flushDenormals()
+{
+#ifdef TUNER_HAS_MXCSR
+    // Бит 15 — flush-to-zero, бит 6 — denormals-are-zero
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+#elif defined(__aarch64__)
+    // FPCR.FZ
+    unsigned long fpcr;
+    __asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+    __asm__ volatile("msr fpcr, %0" : : "r"(fpcr | (1UL << 24)));
+#endif
+}
+
+void RealtimeSupport::prefaultStack()
+{
+    // Касаемся страниц стека заранее, чтобы первый глубокий вызов не ждал ядро
+    volatile unsigned char block[STACK_PREFAULT_BYTES];
+    for (int i = 0; i < STACK_PREFAULT_BYTES; i += 4096) {
+        block[i] = 0;
+    }
+}
+
+QStringList RealtimeSupport::configureCurrentThread(const Settings& settings)
+{
+    QStringList problems;
+    flushDenormals();
+
+#ifdef Q_OS_LINUX
+    if (settings.realtime) {
+        int priority = qBound(1, settings.priority, 99);
+
+        // Без CAP_SYS_NICE приоритет ограничен RLIMIT_RTPRIO
+        rlimit limit;
+        if (getrlimit(RLIMIT_RTPRIO, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY
+            && limit.rlim_cur > 0 && rlim_t(priority) > limit.rlim_cur) {
+            priority = int(limit.rlim_cur);
+        }
+
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (error != 0) {
+            error = pthread_setschedparam(pthread_self(), SCHED_RR, &param);
+        }
+        if (error != 0) {
+            // Приоритеты QThread для SCHED_OTHER в Linux не действуют — замены нет
+            problems << QString("no realtime priority (SCHED_FIFO/RR %1: %2)")
+                            .arg(priority).arg(std::strerror(error));
+        }
+    }
+
+    if (!settings.cpus.isEmpty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : settings.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error != 0) {
+            problems << QString("CPU affinity: %1").arg(std::strerror(error));
+        }
+    }
+#else
+    if (settings.realtime) {
+        QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
+    }
+    if (!settings.cpus.isEmpty()) {
+        problems << "CPU affinity is only supported on Linux";
+    }
+#endif
+
+    if (settings.lockMemory) {
+        prefaultStack();
+    }
+    return problems;
+}
+
+QStringList RealtimeSupport::lockProcessMemory()
+{
+    QStringList problems;
+#ifdef Q_OS_LINUX
+    // Ядро сравнивает с RLIMIT_MEMLOCK весь размер адресного пространства
+    // (без CAP_IPC_LOCK); проверяем заранее, чтобы назвать причину вместо ENOMEM
+    QString limitProblem;
+    rlimit limit;
+    if (getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+        const quint64 mapped = mappedBytes();
+        if (mapped > quint64(limit.rlim_cur)) {
+            limitProblem = QString("mlockall: process maps %1 MB, RLIMIT_MEMLOCK is %2 MB")
+                               .arg(mapped >> 20).arg(quint64(limit.rlim_cur) >> 20);
+        }
+    }
+#ifdef __GLIBC__
+    mallopt(M_TRIM_THRESHOLD, -1);
+#endif
+    // С CAP_IPC_LOCK лимит не действует, поэтому пробуем в любом случае
+    if (mlockall(MCL_CURRENT) != 0) {
+        problems << (limitProblem.isEmpty() ? QString("mlockall: %1").arg(std::strerror(errno))
+                                            : limitProblem);
+    }
+#else
+    problems << "Memory locking is only supported on Linux";
+#endif
+    return problems;
+}
+
+QList<int> RealtimeSupport::parseCpuList(const QString& text)
+{
+    QList<int> cpus;
+    const QStringList parts = text.split(',', Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        const QStringList range = part.trimmed().split('-');
+        bool okFirst = false;
+        bool okLast = false;
+        int first = range.value(0).toInt(&okFirst);
+        int last = range.size() > 1 ? range.value(1).toInt(&okLast) : first;
+        if (!okFirst || (range.size() > 1 && !okLast)) continue;
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus << cpu;
+        }
+    }
+    return cpus;
+}
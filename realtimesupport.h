@@ -0,0 +1,48 @@
+#ifndef REALTIMESUPPORT_H
+#define REALTIMESUPPORT_H
+
+#include <QList>
+#include <QStringList>
+
+// Настройка потоков аудиотракта: планирование реального времени,
+// привязка к ядрам, фиксация памяти и сброс денормализованных чисел.
+// Все функции возвращают список того, что получить не удалось
+// (пустой список — всё применено), и ничего не прерывают.
+class RealtimeSupport
+{
+public:
+    struct Settings {
+        bool realtime = false;      // SCHED_FIFO, при отказе SCHED_RR
+        int priority = 70;          // 1..99, ограничивается RLIMIT_RTPRIO
+        QList<int> cpus;            // Пусто — без привязки
+        bool lockMemory = false;    // mlockall(MCL_CURRENT) + небольшой стек с предварительным касанием
+
+        bool isEmpty() const { return !realtime && cpus.isEmpty() && !lockMemory; }
+    };
+
+    // Стек потоков анализа при фиксации памяти: mlockall фиксирует стек
+    // целиком, а 8 МБ по умолчанию на поток быстро исчерпывают RLIMIT_MEMLOCK
+    static const uint ANALYSIS_STACK_BYTES = 512 * 1024;
+
+    // Вызывается из самого настраиваемого потока. Без SCHED_FIFO/RR на Linux
+    // поток остаётся в SCHED_OTHER — QThread-приоритет там ничего не меняет
+    static QStringList configureCurrentThread(const Settings& settings);
+
+    // Для всего процесса: фиксирует уже отображённые страницы (MCL_CURRENT),
+    // поэтому вызывается после того, как потоки и буферы анализа созданы.
+    // Будущие потоки и рост кучи не фиксируются и не упираются в RLIMIT_MEMLOCK;
+    // освобождённая куча не возвращается системе (иначе повторные page fault)
+    static QStringList lockProcessMemory();
+
+    // FTZ/DAZ для текущего потока: затухающие хвосты IIR-фильтров в тишине
+    // иначе уходят в денормализованные числа, которые в десятки раз медленнее
+    static void flushDenormals();
+
+    // Разбор списка ядер вида "2,3" или "0-3"
+    static QList<int> parseCpuList(const QString& text);
+
+private:
+    static void prefaultStack();
+};
+
+#endif // REALTIMESUPPORT_H
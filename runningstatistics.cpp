@@ -0,0 +1,141 @@
+#include "runningstatistics.h"
+#include <algorithm>
+#include <cmath>
+
+P2Quantile::P2Quantile(double probability)
+    : p(probability)
+{
+    reset();
+}
+
+void P2Quantile::reset()
+{
+    count = 0;
+    for (int i = 0; i < 5; ++i) {
+        heights[i] = 0.0;
+        positions[i] = i;
+    }
+    desired[0] = 0.0;
+    desired[1] = 2.0 * p;
+    desired[2] = 4.0 * p;
+    desired[3] = 2.0 + 2.0 * p;
+    desired[4] = 4.0;
+    increments[0] = 0.0;
+    increments[1] = p / 2.0;
+    increments[2] = p;
+    increments[3] = (1.0 + p) / 2.0;
+    increments[4] = 1.0;
+}
+
+double P2Quantile::parabolic(int i, double d) const
+{
+    return heights[i] + d / (positions[i + 1] - positions[i - 1])
+        * ((positions[i] - positions[i - 1] + d) * (heights[i + 1] - heights[i]) / (positions[i + 1] - positions[i])
+           + (positions[i + 1] - positions[i] - d) * (heights[i] - heights[i - 1]) / (positions[i] - positions[i - 1]));
+}
+
+double P2Quantile::linear(int i, int d) const
+{
+    return heights[i] + d * (heights[i + d] - heights[i]) / (positions[i + d] - positions[i]);
+}
+
+void P2Quantile::add(double x)
+{
+    // Первые пять наблюдений становятся маркерами как есть
+    if (count < 5) {
+        heights[count++] = x;
+        if (count == 5) std::sort(heights, heights + 5);
+        return;
+    }
+    ++count;
+
+    int k;
+    if (x < heights[0]) {
+        heights[0] = x;
+        k = 0;
+    } else if (x >= heights[4]) {
+        heights[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (x >= heights[k + 1]) ++k;
+    }
+
+    for (int i = k + 1; i < 5; ++i) positions[i] += 1.0;
+    for (int i = 0; i < 5; ++i) desired[i] += increments[i];
+
+    // Средние маркеры подтягиваются к желаемым позициям не более чем на 1
+    for (int i = 1; i < 4; ++i) {
+        double d = desired[i] - positions[i];
+        if ((d >= 1.0 && positions[i + 1] - positions[i] > 1.0)
+            || (d <= -1.0 && positions[i - 1] - positions[i] < -1.0)) {
+            int step = d > 0 ? 1 : -1;
+            double candidate = parabolic(i, step);
+            if (heights[i - 1] < candidate && candidate < heights[i + 1]) {
+                heights[i] = candidate;
+            } else {
+                heights[i] = linear(i, step);
+            }
+            positions[i] += step;
+        }
+    }
+}
+
+double P2Quantile::value() const
+{
+    if (count >= 5) return heights[2];
+    if (count == 0) return 0.0;
+
+    // Вставками: наблюдений меньше пяти
+    double sorted[5];
+    for (int i = 0; i < count; ++i) {
+        int j = i;
+        while (j > 0 && sorted[j - 1] > heights[i]) {
+            sorted[j] = sorted[j - 1];
+            --j;
+        }
+        sorted[j] = heights[i];
+    }
+    int index = int(std::lround(p * (count - 1)));
+    return sorted[index];
+}
+
+RunningStatistics::RunningStatistics()
+    : p5(0.05),
+    p50(0.5),
+    p95(0.95)
+{
+    reset();
+}
+
+void RunningStatistics::reset()
+{
+    n = 0;
+    average = 0.0;
+    m2 = 0.0;
+    low = 0.0;
+    high = 0.0;
+    p5.reset();
+    p50.reset();
+    p95.reset();
+}
+
+void RunningStatistics::add(double x)
+{
+    ++n;
+    double delta = x - average;
+    average += delta / n;
+    m2 += delta * (x - average);
+
+    low = n == 1 ? x : std::min(low, x);
+    high = n == 1 ? x : std::max(high, x);
+
+    p5.add(x);
+    p50.add(x);
+    p95.add(x);
+}
+
+double RunningStatistics::standardDeviation() const
+{
+    return std::sqrt(variance());
+}
@@ -0,0 +1,60 @@
+#ifndef RUNNINGSTATISTICS_H
+#define RUNNINGSTATISTICS_H
+
+// Оценка квантиля потоком по алгоритму P² (Jain, Chlamtac, 1985):
+// пять маркеров вместо хранения выборки, память не растёт.
+class P2Quantile
+{
+public:
+    explicit P2Quantile(double probability = 0.5);
+
+    void add(double x);
+    void reset();
+    // До пяти наблюдений — ближайшее из накопленных, 0 — если их нет
+    double value() const;
+    double probability() const { return p; }
+
+private:
+    double parabolic(int i, double d) const;
+    double linear(int i, int d) const;
+
+    double p;
+    int count;
+    double heights[5];
+    double positions[5];
+    double desired[5];
+    double increments[5];
+};
+
+// Среднее и дисперсия по Уэлфорду, минимум, максимум и три квантиля (5, 50, 95 %)
+class RunningStatistics
+{
+public:
+    RunningStatistics();
+
+    void add(double x);
+    void reset();
+
+    long long count() const { return n; }
+    double mean() const { return n > 0 ? average : 0.0; }
+    // Выборочная дисперсия (n - 1)
+    double variance() const { return n > 1 ? m2 / (n - 1) : 0.0; }
+    double standardDeviation() const;
+    double minimum() const { return n > 0 ? low : 0.0; }
+    double maximum() const { return n > 0 ? high : 0.0; }
+    double percentile5() const { return p5.value(); }
+    double median() const { return p50.value(); }
+    double percentile95() const { return p95.value(); }
+
+private:
+    long long n;
+    double average;
+    double m2;
+    double low;
+    double high;
+    P2Quantile p5;
+    P2Quantile p50;
+    P2Quantile p95;
+};
+
+#endif // RUNNINGSTATISTICS_H
@@ -0,0 +1,132 @@
+#ifndef SIMDFLOAT_H
+#define SIMDFLOAT_H
+
+// Минимальная обёртка над 4-канальным SIMD-вектором float.
+// На x86 (включая MinGW x64) используется SSE, иначе — скалярная реализация
+// с той же семантикой.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TUNER_SIMD_SSE 1
+#endif
+
+struct SimdFloat4
+{
+    static const int LANES = 4;
+
+#ifdef TUNER_SIMD_SSE
+    __m128 v;
+
+    static SimdFloat4 zero() { return {_mm_setzero_ps()}; }
+    static SimdFloat4 broadcast(float x) { return {_mm_set1_ps(x)}; }
+    static SimdFloat4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    // Сдвигает каналы на один вверх (lane[i] = lane[i-1]) и кладёт x в lane[0]
+    SimdFloat4 shiftIn(float x) const
+    {
+        return {_mm_move_ss(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 1, 0, 0)), _mm_set_ss(x))};
+    }
+    float lastLane() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+    friend SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b) { return {_mm_add_ps(a.v, b.v)}; }
+    friend SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+    friend SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+    friend SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b) { return {_mm_div_ps(a.v, b.v)}; }
+
+    // Маски — результат сравнений, используются только в select/&/|/andNot/allTrue
+    static SimdFloat4 lessThan(SimdFloat4 a, SimdFloat4 b) { return {_mm_cmplt_ps(a.v, b.v)}; }
+    static SimdFloat4 lessEqual(SimdFloat4 a, SimdFloat4 b) { return {_mm_cmple_ps(a.v, b.v)}; }
+    static SimdFloat4 greaterThan(SimdFloat4 a, SimdFloat4 b) { return {_mm_cmpgt_ps(a.v, b.v)}; }
+    static SimdFloat4 noLanes() { return {_mm_setzero_ps()}; }
+    friend SimdFloat4 operator&(SimdFloat4 a, SimdFloat4 b) { return {_mm_and_ps(a.v, b.v)}; }
+    friend SimdFloat4 operator|(SimdFloat4 a, SimdFloat4 b) { return {_mm_or_ps(a.v, b.v)}; }
+    // (~mask) & b
+    static SimdFloat4 andNot(SimdFloat4 mask, SimdFloat4 b) { return {_mm_andnot_ps(mask.v, b.v)}; }
+    static SimdFloat4 select(SimdFloat4 mask, SimdFloat4 a, SimdFloat4 b)
+    {
+        return {_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))};
+    }
+    bool allTrue() const { return _mm_movemask_ps(v) == 0xF; }
+
+    // (v0 + v2) + (v1 + v3)
+    float sum() const
+    {
+        __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1))));
+    }
+#else
+    float v[4];
+
+    static SimdFloat4 zero() { return {{0.0f, 0.0f, 0.0f, 0.0f}}; }
+    static SimdFloat4 broadcast(float x) { return {{x, x, x, x}}; }
+    static SimdFloat4 load(const float* p) { return {{p[0], p[1], p[2], p[3]}}; }
+    void store(float* p) const { for (int i = 0; i < 4; ++i) p[i] = v[i]; }
+
+    SimdFloat4 shiftIn(float x) const { return {{x, v[0], v[1], v[2]}}; }
+    float lastLane() const { return v[3]; }
+
+    friend SimdFloat4 operator+(SimdFloat4 a, SimdFloat4 b)
+    {
+        return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+    }
+    friend SimdFloat4 operator-(SimdFloat4 a, SimdFloat4 b)
+    {
+        return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+    }
+    friend SimdFloat4 operator*(SimdFloat4 a, SimdFloat4 b)
+    {
+        return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+    }
+    friend SimdFloat4 operator/(SimdFloat4 a, SimdFloat4 b)
+    {
+        return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}};
+    }
+
+    // Маски хранятся как 1.0f / 0.0f
+    static SimdFloat4 lessThan(SimdFloat4 a, SimdFloat4 b)
+    {
+        SimdFloat4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? 1.0f : 0.0f;
+        return r;
+    }
+    static SimdFloat4 lessEqual(SimdFloat4 a, SimdFloat4 b)
+    {
+        SimdFloat4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] <= b.v[i] ? 1.0f : 0.0f;
+        return r;
+    }
+    static SimdFloat4 greaterThan(SimdFloat4 a, SimdFloat4 b) { return lessThan(b, a); }
+    static SimdFloat4 noLanes() { return zero(); }
+    friend SimdFloat4 operator&(SimdFloat4 a, SimdFloat4 b)
+    {
+        SimdFloat4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = (a.v[i] != 0.0f && b.v[i] != 0.0f) ? 1.0f : 0.0f;
+        return r;
+    }
+    friend SimdFloat4 operator|(SimdFloat4 a, SimdFloat4 b)
+    {
+        SimdFloat4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = (a.v[i] != 0.0f || b.v[i] != 0.0f) ? 1.0f : 0.0f;
+        return r;
+    }
+    static SimdFloat4 andNot(SimdFloat4 mask, SimdFloat4 b)
+    {
+        SimdFloat4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = (mask.v[i] == 0.0f && b.v[i] != 0.0f) ? 1.0f : 0.0f;
+        return r;
+    }
+    static SimdFloat4 select(SimdFloat4 mask, SimdFloat4 a, SimdFloat4 b)
+    {
+        SimdFloat4 r;
+        for (int i = 0; i < 4; ++i) r.v[i] = mask.v[i] != 0.0f ? a.v[i] : b.v[i];
+        return r;
+    }
+    bool allTrue() const { return v[0] != 0.0f && v[1] != 0.0f && v[2] != 0.0f && v[3] != 0.0f; }
+
+    // Тот же порядок сложения, что и в SSE-варианте
+    float sum() const { return (v[0] + v[2]) + (v[1] + v[3]); }
+#endif
+};
+
+#endif // SIMDFLOAT_H
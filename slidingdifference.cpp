@@ -0,0 +1,82 @@
+#include "slidingdifference.h"
+#include <algorithm>
+
+namespace {
+// Полный пересчёт раз в столько окон: амортизированно это дешевле инкремента
+const int REFRESH_WINDOWS = 8;
+}
+
+SlidingDifference::SlidingDifference(int windowSize, int lagCount)
+    : window(windowSize),
+    integration(windowSize / 2),
+    lags(lagCount > 0 ? std::min(lagCount - 1, windowSize / 2) : windowSize / 2),
+    refreshInterval(windowSize * REFRESH_WINDOWS),
+    sinceRefresh(0),
+    position(0)
+{
+    reset();
+}
+
+void SlidingDifference::reset()
+{
+    history.assign(2 * size_t(window), 0.0f);
+    diff.assign(lags + 1, 0.0);
+    position = 0;
+    sinceRefresh = 0;
+}
+
+void SlidingDifference::push(const float* samples, int count)
+{
+    for (int n = 0; n < count; ++n) {
+        // x — текущее окно до сдвига: x[0] уходит, новый отсчёт станет x[window]
+        const float* x = &history[position];
+        const float incoming = samples[n];
+
+        // Уходящий член: пара (x[0], x[tau]); входящий: (x[integration], x[integration + tau]),
+        // где x[window] — новый отсчёт
+        const float leaving = x[0];
+        const float entering = x[integration];
+        const int inWindow = std::min(lags, window - integration - 1);
+        for (int tau = 0; tau <= inWindow; ++tau) {
+            const float out = leaving - x[tau];
+            const float in = entering - x[integration + tau];
+            diff[tau] += double(in) * in - double(out) * out;
+        }
+        if (inWindow < lags) {
+            // Самый длинный лаг дотягивается до нового отсчёта
+            const float out = leaving - x[lags];
+            const float in = entering - incoming;
+            diff[lags] += double(in) * in - double(out) * out;
+        }
+
+        history[position] = incoming;
+        history[position + window] = incoming;
+        if (++position == window) position = 0;
+    }
+
+    sinceRefresh += count;
+    if (sinceRefresh >= refreshInterval) {
+        recompute();
+    }
+}
+
+void SlidingDifference::recompute()
+{
+    const float* x = &history[position];
+    for (int tau = 0; tau <= lags; ++tau) {
+        double sum = 0.0;
+        for (int j = 0; j < integration; ++j) {
+            const double d = double(x[j]) - x[j + tau];
+            sum += d * d;
+        }
+        diff[tau] = sum;
+    }
+    sinceRefresh = 0;
+}
+
+void SlidingDifference::copyTo(float* out) const
+{
+    for (int tau = 0; tau <= lags; ++tau) {
+        out[tau] = float(std::max(0.0, diff[tau]));
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef SLIDINGDIFFERENCE_H
+#define SLIDINGDIFFERENCE_H
+
+#include <vector>
+
+// Разностная функция YIN, обновляемая инкрементально по мере прихода отсчётов.
+// Окно windowSize, интегрирование по первой половине, лаги 0..lagCount - 1
+// (не больше windowSize / 2) — так же, как в YinKernel, поэтому результат
+// можно сразу отдать в YinKernel::candidatesFromDifference().
+//
+// На каждый новый отсчёт d(tau) получает один входящий и теряет один уходящий
+// член, поэтому стоимость хопа — O(hop * лаги) и не зависит от длины окна.
+// Накопление идёт в double; раз в несколько окон функция пересчитывается
+// целиком, чтобы ошибка округления не накапливалась.
+class SlidingDifference
+{
+public:
+    // lagCount — обычно YinKernel::scratchSize(); 0 — все лаги до windowSize / 2
+    explicit SlidingDifference(int windowSize, int lagCount = 0);
+
+    void reset();
+    void push(const float* samples, int count);
+
+    // Копирует текущие d(tau) в out (lagCount() значений)
+    void copyTo(float* out) const;
+    int lagCount() const { return lags + 1; }
+
+private:
+    void recompute();
+
+    int window;
+    int integration;
+    int lags;
+    int refreshInterval;
+    int sinceRefresh;
+
+    std::vector<float> history;  // Зеркальное кольцо на window отсчётов
+    int position;                // Позиция самого старого отсчёта окна
+    std::vector<double> diff;
+};
+
+#endif // SLIDINGDIFFERENCE_H
@@ -0,0 +1,126 @@
+#include "spectraldifference.h"
+#include <algorithm>
+#include <cmath>
+
+SpectralDifference::SpectralDifference(int windowSize, const Settings& settings)
+    : window(windowSize),
+    fftSize(1),
+    bins(0),
+    settings(settings),
+    fft(nullptr),
+    frame(nullptr),
+    spectrum(nullptr),
+    headSpectrum(nullptr),
+    cleaned(nullptr),
+    correlation(nullptr),
+    calibrating(false),
+    accumulatedFrames(0)
+{
+    // Дополнение нулями до 2W: корреляция линейная, без заворота
+    while (fftSize < 2 * windowSize) {
+        fftSize *= 2;
+    }
+    bins = fftSize / 2 + 1;
+
+    fft = new_aubio_fft(fftSize);
+    frame = new_fvec(fftSize);
+    spectrum = new_cvec(fftSize);
+    headSpectrum = new_cvec(fftSize);
+    cleaned = new_fvec(fftSize);
+    correlation = new_fvec(fftSize);
+    energy.assign(windowSize + 1, 0.0);
+}
+
+SpectralDifference::~SpectralDifference()
+{
+    if (fft) del_aubio_fft(fft);
+    if (frame) del_fvec(frame);
+    if (spectrum) del_cvec(spectrum);
+    if (headSpectrum) del_cvec(headSpectrum);
+    if (cleaned) del_fvec(cleaned);
+    if (correlation) del_fvec(correlation);
+}
+
+void SpectralDifference::beginCalibration()
+{
+    noiseSum.assign(bins, 0.0);
+    accumulatedFrames = 0;
+    calibrating = true;
+}
+
+bool SpectralDifference::endCalibration()
+{
+    calibrating = false;
+    if (accumulatedFrames == 0) return false;
+
+    noise.resize(bins);
+    for (int k = 0; k < bins; ++k) {
+        noise[k] = float(noiseSum[k] / accumulatedFrames);
+    }
+    return true;
+}
+
+void SpectralDifference::setNoiseProfile(const std::vector<float>& powerSpectrum)
+{
+    if (int(powerSpectrum.size()) == bins) {
+        noise = powerSpectrum;
+    } else {
+        noise.clear();
+    }
+}
+
+void SpectralDifference::compute(const float* samples, float* diff, int lagCount)
+{
+    std::copy(samples, samples + window, frame->data);
+    std::fill(frame->data + window, frame->data + fftSize, 0.0f);
+    aubio_fft_do(fft, frame, spectrum);
+
+    // Калибровка копит спектр мощности того же кадра; очистка — усиление
+    // по полосам с нулевой фазой, так что без профиля сигнал не меняется
+    const bool suppress = !calibrating && !noise.empty();
+    for (int k = 0; k < bins; ++k) {
+        float power = spectrum->norm[k] * spectrum->norm[k];
+
+        if (calibrating) {
+            noiseSum[k] += power;
+        } else if (suppress) {
+            // Спектральное вычитание в мощности с порогом усиления
+            float gain = power > 0.0f ? 1.0f - settings.overSubtraction * noise[k] / power : 0.0f;
+            spectrum->norm[k] *= std::sqrt(std::max(gain, settings.gainFloor));
+        }
+    }
+    if (calibrating) ++accumulatedFrames;
+
+    const float* y = frame->data;
+    if (suppress) {
+        aubio_fft_rdo(fft, spectrum, cleaned);
+        y = cleaned->data;
+    }
+
+    // d(tau) = E(0, I) + E(tau, tau + I) - 2 * sum x[j] x[j + tau], I = W / 2 — как в YinKernel.
+    // Корреляция первой половины окна со всем окном: IFFT(conj(A) * Y).
+    const int integration = window / 2;
+    std::copy(y, y + integration, correlation->data);
+    std::fill(correlation->data + integration, correlation->data + fftSize, 0.0f);
+    aubio_fft_do(fft, correlation, headSpectrum);
+    for (int k = 0; k < bins; ++k) {
+        headSpectrum->norm[k] *= spectrum->norm[k];
+        headSpectrum->phas[k] = spectrum->phas[k] - headSpectrum->phas[k];
+    }
+    aubio_fft_rdo(fft, headSpectrum, correlation);
+    const float* r = correlation->data;
+
+    // Энергии скользящего отрезка — через накопленную сумму квадратов
+    energy[0] = 0.0;
+    for (int j = 0; j < window; ++j) {
+        energy[j + 1] = energy[j] + double(y[j]) * y[j];
+    }
+
+    diff[0] = 0.0f;
+    const int lags = std::min(lagCount, window - integration + 1);
+    const double headEnergy = energy[integration];
+    for (int tau = 1; tau < lags; ++tau) {
+        double value = headEnergy + (energy[tau + integration] - energy[tau]) - 2.0 * r[tau];
+        diff[tau] = float(std::max(0.0, value));
+    }
+}
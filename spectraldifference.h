@@ -0,0 +1,66 @@
+#ifndef SPECTRALDIFFERENCE_H
+#define SPECTRALDIFFERENCE_H
+
+#include <aubio/aubio.h>
+#include <vector>
+
+// Разностная функция YIN через БПФ с подавлением выученного фонового шума.
+//
+// Прямой БПФ окна общий для всего: его спектр мощности копится при калибровке
+// и по нему считается усиление спектрального вычитания (с порогом, чтобы не было
+// "музыкального шума"). Очищенный сигнал y (нулевая фаза) даёт ту же разностную
+// функцию, что и YinKernel: d(tau) = E(0, I) + E(tau, tau + I) - 2 * xcorr(tau),
+// где I = W / 2, xcorr — корреляция первой половины окна со всем окном через БПФ,
+// а энергии — из накопленной суммы квадратов. Без профиля y совпадает со входом,
+// и результат равен YinKernel::analyze с точностью до округления.
+class SpectralDifference
+{
+public:
+    struct Settings {
+        float overSubtraction = 2.0f;  // Во сколько раз шум вычитается с запасом
+        float gainFloor = 0.02f;       // Минимальное усиление полосы (-17 дБ по мощности)
+    };
+
+    SpectralDifference(int windowSize, const Settings& settings);
+    ~SpectralDifference();
+
+    // Калибровка: спектры следующих кадров усредняются в профиль шума
+    void beginCalibration();
+    // false, если не набралось ни одного кадра
+    bool endCalibration();
+    bool isCalibrating() const { return calibrating; }
+    int calibrationFrames() const { return accumulatedFrames; }
+
+    void setNoiseProfile(const std::vector<float>& powerSpectrum);
+    const std::vector<float>& noiseProfile() const { return noise; }
+    bool hasNoiseProfile() const { return !noise.empty(); }
+    void clearNoiseProfile() { noise.clear(); }
+    int spectrumSize() const { return bins; }
+
+    // window — windowSize отсчётов; diff — lagCount значений (YinKernel::scratchSize())
+    void compute(const float* window, float* diff, int lagCount);
+
+private:
+    SpectralDifference(const SpectralDifference&) = delete;
+    SpectralDifference& operator=(const SpectralDifference&) = delete;
+
+    int window;
+    int fftSize;
+    int bins;
+    Settings settings;
+
+    aubio_fft_t* fft;
+    fvec_t* frame;
+    cvec_t* spectrum;
+    cvec_t* headSpectrum;
+    fvec_t* cleaned;
+    fvec_t* correlation;
+    std::vector<double> energy;
+
+    bool calibrating;
+    int accumulatedFrames;
+    std::vector<double> noiseSum;
+    std::vector<float> noise;
+};
+
+#endif // SPECTRALDIFFERENCE_H
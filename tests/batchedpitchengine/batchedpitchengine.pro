@@ -0,0 +1,19 @@
+QT       += testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_batchedpitchengine
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../batchedpitchengine.cpp \
+    ../../yinkernel.cpp \
+    tst_batchedpitchengine.cpp
+
+HEADERS += \
+    ../../batchedpitchengine.h \
+    ../../simdfloat.h \
+    ../../yinkernel.h
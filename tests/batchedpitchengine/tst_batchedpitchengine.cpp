@@ -0,0 +1,134 @@
+#include <QtTest>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "batchedpitchengine.h"
+
+namespace {
+const int WINDOW = 2048;
+const int HOP = 512;
+const float RATE = 48000.0f;
+const float MIN_FREQUENCY = 70.0f;
+const float MAX_FREQUENCY = 1400.0f;
+const int HOPS = 10;
+
+// Поток s — своя нота гитарного диапазона со своими гармониками
+double streamFrequency(int stream)
+{
+    return 82.41 * std::pow(2.0, (stream % 24) / 12.0);
+}
+
+std::vector<float> streamSignal(int stream)
+{
+    const double f0 = streamFrequency(stream);
+    std::vector<float> x(HOPS * HOP);
+    for (size_t i = 0; i < x.size(); ++i) {
+        const double t = i / RATE;
+        x[i] = float(0.6 * std::sin(2.0 * M_PI * f0 * t)
+                     + 0.3 * std::sin(2.0 * M_PI * 2.0 * f0 * t + stream)
+                     + 0.1 * std::sin(2.0 * M_PI * 3.0 * f0 * t));
+    }
+    return x;
+}
+
+std::vector<std::vector<float>> streamSignals(int streams)
+{
+    std::vector<std::vector<float>> signals;
+    for (int stream = 0; stream < streams; ++stream) {
+        signals.push_back(streamSignal(stream));
+    }
+    return signals;
+}
+}
+
+class TestBatchedPitchEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void groupsMatchPerStream();
+    void benchmarkBatched();
+    void benchmarkPerStream();
+};
+
+// Группа из lanes потоков должна давать то же, что обработка каждого потока
+// по одному (processSingle). Порядок суммирования разностной функции разный,
+// поэтому сравнение с допуском.
+void TestBatchedPitchEngine::groupsMatchPerStream()
+{
+    for (int lanes : {4, 8, 16}) {
+        // Полная группа и остаток, который идёт через processSingle
+        const int streams = lanes + 3;
+        const std::vector<std::vector<float>> signals = streamSignals(streams);
+
+        BatchedPitchEngine batched(streams, RATE, WINDOW, HOP, MIN_FREQUENCY, MAX_FREQUENCY, lanes);
+        QCOMPARE(batched.groupCount(), 1);
+        QCOMPARE(batched.leftoverCount(), 3);
+
+        // Один поток меньше группы — всегда processSingle
+        std::vector<std::unique_ptr<BatchedPitchEngine>> single;
+        for (int stream = 0; stream < streams; ++stream) {
+            single.emplace_back(new BatchedPitchEngine(1, RATE, WINDOW, HOP, MIN_FREQUENCY, MAX_FREQUENCY, lanes));
+            QCOMPARE(single.back()->groupCount(), 0);
+        }
+
+        std::vector<float> pitches(streams);
+        std::vector<float> confidences(streams);
+        std::vector<const float*> hops(streams);
+        for (int h = 0; h < HOPS; ++h) {
+            for (int stream = 0; stream < streams; ++stream) {
+                hops[stream] = signals[stream].data() + h * HOP;
+            }
+            batched.process(hops.data(), pitches.data(), confidences.data());
+
+            for (int stream = 0; stream < streams; ++stream) {
+                float pitch = 0.0f;
+                float confidence = 0.0f;
+                single[stream]->process(&hops[stream], &pitch, &confidence);
+                QVERIFY(std::fabs(pitches[stream] - pitch) <= 1e-4f * std::max(1.0f, pitch));
+                QVERIFY(std::fabs(confidences[stream] - confidence) <= 1e-3f);
+            }
+        }
+
+        // Окно заполнено — питч каждого потока верный
+        for (int stream = 0; stream < streams; ++stream) {
+            QVERIFY(std::fabs(pitches[stream] / streamFrequency(stream) - 1.0) < 0.01);
+        }
+    }
+}
+
+void TestBatchedPitchEngine::benchmarkBatched()
+{
+    const int streams = 16;
+    const std::vector<std::vector<float>> signals = streamSignals(streams);
+    BatchedPitchEngine engine(streams, RATE, WINDOW, HOP, MIN_FREQUENCY, MAX_FREQUENCY, 8);
+    std::vector<float> pitches(streams);
+    std::vector<const float*> hops(streams);
+    for (int stream = 0; stream < streams; ++stream) hops[stream] = signals[stream].data();
+
+    QBENCHMARK {
+        engine.process(hops.data(), pitches.data(), nullptr);
+    }
+}
+
+void TestBatchedPitchEngine::benchmarkPerStream()
+{
+    const int streams = 16;
+    const std::vector<std::vector<float>> signals = streamSignals(streams);
+    std::vector<std::unique_ptr<BatchedPitchEngine>> engines;
+    for (int stream = 0; stream < streams; ++stream) {
+        engines.emplace_back(new BatchedPitchEngine(1, RATE, WINDOW, HOP, MIN_FREQUENCY, MAX_FREQUENCY));
+    }
+    float pitch = 0.0f;
+
+    QBENCHMARK {
+        for (int stream = 0; stream < streams; ++stream) {
+            const float* hop = signals[stream].data();
+            engines[stream]->process(&hop, &pitch, nullptr);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(TestBatchedPitchEngine)
+
+#include "tst_batchedpitchengine.moc"
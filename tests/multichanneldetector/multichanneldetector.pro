@@ -0,0 +1,19 @@
+QT       += testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_multichanneldetector
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../multichanneldetector.cpp \
+    ../../yinkernel.cpp \
+    tst_multichanneldetector.cpp
+
+HEADERS += \
+    ../../multichanneldetector.h \
+    ../../simdfloat.h \
+    ../../yinkernel.h
@@ -0,0 +1,127 @@
+#include <QtTest>
+#include <QThread>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "multichanneldetector.h"
+
+namespace {
+const int CHANNELS = 8;
+const int WINDOW = 2048;
+const int HOP = 512;
+const float RATE = 48000.0f;
+const int HOPS = 12;
+
+// Канал c — своя нота (E2 и выше по квартам) со своими гармониками
+double channelFrequency(int channel)
+{
+    return 82.41 * std::pow(2.0, channel * 5 / 12.0);
+}
+
+std::vector<float> channelSignal(int channel)
+{
+    const double f0 = channelFrequency(channel);
+    std::vector<float> x(HOPS * HOP);
+    for (size_t i = 0; i < x.size(); ++i) {
+        const double t = i / RATE;
+        x[i] = float(0.6 * std::sin(2.0 * M_PI * f0 * t)
+                     + 0.3 * std::sin(2.0 * M_PI * 2.0 * f0 * t + channel)
+                     + 0.1 * std::sin(2.0 * M_PI * 3.0 * f0 * t));
+    }
+    return x;
+}
+}
+
+class TestMultiChannelDetector : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void matchesYinKernel();
+    void concurrentChannelsMatchSequential();
+    void channelStateOwnsCacheLine();
+};
+
+// Каждый канал должен давать то же, что отдельное ядро YIN на тех же
+// windowSize последних отсчётах (окно до заполнения дополнено нулями)
+void TestMultiChannelDetector::matchesYinKernel()
+{
+    MultiChannelPitchDetector detector(CHANNELS, RATE, WINDOW, HOP);
+    YinKernel reference(WINDOW, RATE);
+
+    for (int channel = 0; channel < CHANNELS; ++channel) {
+        const std::vector<float> signal = channelSignal(channel);
+        std::vector<float> window(WINDOW, 0.0f);
+        for (int h = 0; h < HOPS; ++h) {
+            const float* hop = signal.data() + h * HOP;
+            const float pitch = detector.process(channel, hop);
+
+            std::move(window.begin() + HOP, window.end(), window.begin());
+            std::copy(hop, hop + HOP, window.end() - HOP);
+            PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+            const int count = reference.analyze(window.data(), candidates, YinKernel::MAX_CANDIDATES);
+            float best = 0.0f;
+            float bestProbability = 0.0f;
+            for (int i = 0; i < count; ++i) {
+                if (candidates[i].probability > bestProbability) {
+                    bestProbability = candidates[i].probability;
+                    best = candidates[i].frequency;
+                }
+            }
+
+            QCOMPARE(pitch, best);
+            QCOMPARE(detector.confidence(channel), bestProbability);
+        }
+        // Окно заполнено — питч канала верный
+        QVERIFY(std::fabs(detector.pitch(channel) / channelFrequency(channel) - 1.0) < 0.01);
+    }
+}
+
+// Разные каналы из разных потоков — тот же результат, что последовательно
+void TestMultiChannelDetector::concurrentChannelsMatchSequential()
+{
+    std::vector<std::vector<float>> signals;
+    for (int channel = 0; channel < CHANNELS; ++channel) {
+        signals.push_back(channelSignal(channel));
+    }
+
+    MultiChannelPitchDetector sequential(CHANNELS, RATE, WINDOW, HOP);
+    std::vector<float> expected(CHANNELS * HOPS);
+    for (int h = 0; h < HOPS; ++h) {
+        for (int channel = 0; channel < CHANNELS; ++channel) {
+            expected[channel * HOPS + h] = sequential.process(channel, signals[channel].data() + h * HOP);
+        }
+    }
+
+    MultiChannelPitchDetector concurrent(CHANNELS, RATE, WINDOW, HOP);
+    std::vector<float> actual(CHANNELS * HOPS);
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (int channel = 0; channel < CHANNELS; ++channel) {
+        threads.emplace_back(QThread::create([&, channel]() {
+            for (int h = 0; h < HOPS; ++h) {
+                actual[channel * HOPS + h] = concurrent.process(channel, signals[channel].data() + h * HOP);
+            }
+        }));
+        threads.back()->start();
+    }
+    for (const std::unique_ptr<QThread>& thread : threads) {
+        thread->wait();
+    }
+
+    for (int i = 0; i < CHANNELS * HOPS; ++i) {
+        QCOMPARE(actual[i], expected[i]);
+    }
+}
+
+void TestMultiChannelDetector::channelStateOwnsCacheLine()
+{
+    // Скаляры: по кэш-линии на канал, плюс выровненные строки истории и буферов
+    const size_t bytes = MultiChannelPitchDetector::arenaBytesFor(CHANNELS, WINDOW);
+    QVERIFY(bytes % MultiChannelPitchDetector::CACHE_LINE == 0);
+    QVERIFY(MultiChannelPitchDetector::arenaBytesFor(CHANNELS + 1, WINDOW) - bytes
+            >= MultiChannelPitchDetector::CACHE_LINE + 2 * WINDOW * sizeof(float));
+}
+
+QTEST_APPLESS_MAIN(TestMultiChannelDetector)
+
+#include "tst_multichanneldetector.moc"
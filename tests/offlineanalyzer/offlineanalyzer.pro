@@ -0,0 +1,48 @@
+QT       += testlib concurrent
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_offlineanalyzer
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../decimator.cpp \
+    ../../instrumentprofile.cpp \
+    ../../offlineanalyzer.cpp \
+    ../../pitchdetector.cpp \
+    ../../pitchtracker.cpp \
+    ../../prefilter.cpp \
+    ../../slidingdifference.cpp \
+    ../../spectraldifference.cpp \
+    ../../yinkernel.cpp \
+    tst_offlineanalyzer.cpp
+
+HEADERS += \
+    ../../decimator.h \
+    ../../instrumentprofile.h \
+    ../../offlineanalyzer.h \
+    ../../pitchdetector.h \
+    ../../pitchtracker.h \
+    ../../prefilter.h \
+    ../../simdfloat.h \
+    ../../slidingdifference.h \
+    ../../spectraldifference.h \
+    ../../yinkernel.h
+
+MSYS2_PATH = C:/msys64/mingw64
+
+win32: {
+    INCLUDEPATH += $$MSYS2_PATH/include
+
+    LIBS += -L$$MSYS2_PATH/lib \
+            -laubio \
+            -lfftw3 \
+            -lsamplerate \
+            -lmpg123 \
+            -lsndfile
+}
+
+unix: LIBS += -laubio
@@ -0,0 +1,143 @@
+#include <QtTest>
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryDir>
+#include <aubio/aubio.h>
+#include <cmath>
+#include <memory>
+#include "offlineanalyzer.h"
+
+namespace {
+const int RATE = 48000;
+
+// Моно WAV 16 бит: ноты по 0.7 с с паузами, чтобы трекер переходил
+// между нотами и тишиной и на границах сегментов
+bool writeTestWav(const QString& path, double seconds)
+{
+    const double notes[] = { 82.41, 110.0, 0.0, 146.83, 196.0, 0.0, 246.94, 329.63 };
+    const int frames = int(seconds * RATE);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    QDataStream out(&file);
+    out.setByteOrder(QDataStream::LittleEndian);
+
+    const quint32 dataBytes = quint32(frames) * 2;
+    out.writeRawData("RIFF", 4);
+    out << quint32(36 + dataBytes);
+    out.writeRawData("WAVEfmt ", 8);
+    out << quint32(16) << quint16(1) << quint16(1) << quint32(RATE) << quint32(RATE * 2)
+        << quint16(2) << quint16(16);
+    out.writeRawData("data", 4);
+    out << dataBytes;
+
+    double phase = 0.0;
+    for (int i = 0; i < frames; ++i) {
+        const double f0 = notes[int(i / (0.7 * RATE)) % 8];
+        phase += 2.0 * M_PI * f0 / RATE;
+        const double value = f0 > 0.0 ? 0.5 * std::sin(phase) + 0.2 * std::sin(2.0 * phase) : 0.0;
+        out << qint16(std::lround(value * 32767.0));
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+// Последовательный проход одним детектором, как в живом режиме
+QVector<OfflinePitchFrame> analyzeSequentially(const QString& path, const OfflineAnalyzer::Settings& settings)
+{
+    const InstrumentProfile& profile = settings.profile;
+    const int hop = profile.hopSize;
+    PitchDetector detector(RATE, profile.windowSize, hop);
+    detector.setPreFilterSettings(settings.preFilter);
+    detector.setFrequencyRange(profile.minFrequency, profile.maxFrequency);
+    detector.setTrackingEnabled(true);
+    if (settings.decimate) {
+        detector.setDecimationFactor(PolyphaseDecimator::factorForRange(RATE, profile.maxFrequency, hop));
+    }
+    const int lag = PitchTracker(detector.trackerSettings()).latencyHops();
+
+    QVector<OfflinePitchFrame> frames;
+    aubio_source_t* source = new_aubio_source(path.toLocal8Bit().constData(), RATE, hop);
+    if (!source) return frames;
+    fvec_t* buffer = new_fvec(hop);
+    long long hopIndex = 0;
+    while (true) {
+        uint_t read = 0;
+        aubio_source_do(source, buffer, &read);
+        if (read == 0) break;
+        std::fill(buffer->data + read, buffer->data + hop, 0.0f);
+
+        // Первые lag хопов трекер ещё не решил
+        const float pitchHz = detector.detect(buffer->data);
+        if (hopIndex++ >= lag) {
+            const long long decided = frames.size();
+            frames.append({ double(decided) * hop / RATE, pitchHz, detector.confidence() });
+        }
+        if (read < uint_t(hop)) break;
+    }
+    del_fvec(buffer);
+    del_aubio_source(source);
+    return frames;
+}
+}
+
+class TestOfflineAnalyzer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void segmentsMatchSequentialPass_data();
+    void segmentsMatchSequentialPass();
+};
+
+void TestOfflineAnalyzer::segmentsMatchSequentialPass_data()
+{
+    QTest::addColumn<bool>("decimate");
+    QTest::addColumn<float>("segmentSeconds");
+
+    QTest::newRow("short segments") << false << 0.25f;
+    // Сегмент короче окна прогрева: несколько сегментов начинаются с одного хопа
+    QTest::newRow("shorter than warmup") << false << 0.02f;
+    QTest::newRow("decimated") << true << 0.3f;
+}
+
+// Сегментный анализ на нескольких потоках должен совпадать с одним
+// детектором бит в бит; последние lag хопов одиночный проход не решает
+void TestOfflineAnalyzer::segmentsMatchSequentialPass()
+{
+    QFETCH(bool, decimate);
+    QFETCH(float, segmentSeconds);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("take.wav");
+    QVERIFY(writeTestWav(path, 4.0));
+
+    OfflineAnalyzer::Settings settings;
+    settings.decimate = decimate;
+    settings.segmentSeconds = segmentSeconds;
+    settings.threads = 4;
+
+    OfflineAnalyzer analyzer(settings);
+    QVector<OfflinePitchFrame> frames;
+    QString error;
+    QVERIFY2(analyzer.analyze(path, frames, error), qPrintable(error));
+
+    const QVector<OfflinePitchFrame> expected = analyzeSequentially(path, settings);
+    QVERIFY(!expected.isEmpty());
+    QVERIFY(frames.size() > expected.size());
+
+    int voiced = 0;
+    for (int i = 0; i < expected.size(); ++i) {
+        QVERIFY2(frames[i].pitchHz == expected[i].pitchHz,
+                 qPrintable(QString("hop %1: %2 != %3").arg(i).arg(frames[i].pitchHz).arg(expected[i].pitchHz)));
+        QVERIFY2(frames[i].confidence == expected[i].confidence, qPrintable(QString("hop %1").arg(i)));
+        QCOMPARE(frames[i].time, expected[i].time);
+        if (expected[i].pitchHz > 0.0f) ++voiced;
+    }
+    // Сравнение не вырождено: большая часть нот найдена
+    QVERIFY(voiced > expected.size() / 2);
+}
+
+QTEST_GUILESS_MAIN(TestOfflineAnalyzer)
+
+#include "tst_offlineanalyzer.moc"
@@ -0,0 +1,7 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    batchedpitchengine \
+    multichanneldetector \
+    offlineanalyzer \
+    yinkernel
@@ -0,0 +1,139 @@
+#include <QtTest>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "yinkernel.h"
+
+class TestYinKernel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void brightLowNote();
+    void specializedMatchesGeneric_data();
+    void specializedMatchesGeneric();
+    void benchmarkSpecialized();
+    void benchmarkGeneric();
+};
+
+namespace {
+// Шумная нота с постоянной составляющей: суммы разностной функции большие,
+// ошибка округления заметна
+std::vector<float> testWindow(int window, float rate)
+{
+    std::mt19937 generator(7);
+    std::normal_distribution<float> noise(0.0f, 0.2f);
+    std::vector<float> x(window);
+    for (int i = 0; i < window; ++i) {
+        const double t = i / rate;
+        x[i] = float(0.3 + std::sin(2.0 * M_PI * 196.0 * t) + 0.5 * std::sin(2.0 * M_PI * 392.0 * t))
+               + noise(generator);
+    }
+    return x;
+}
+}
+
+// Яркая E2 (24 гармоники с медленным спадом) со слабым шумом: до лага истинного
+// периода у нормированной разностной функции десятки мелких впадин
+void TestYinKernel::brightLowNote()
+{
+    const int window = 2048;
+    const float rate = 48000.0f;
+    const double e2 = 82.41;
+    YinKernel kernel(window, rate, 70.0f, 1400.0f);
+
+    std::mt19937 generator(1);
+    std::normal_distribution<float> noise(0.0f, 0.1f);
+    std::vector<float> x(window);
+
+    const int runs = 40;
+    int found = 0;
+    for (int run = 0; run < runs; ++run) {
+        const double phase = run * 0.37;
+        for (int i = 0; i < window; ++i) {
+            double t = i / rate;
+            double value = 0.0;
+            for (int h = 1; h <= 24; ++h) {
+                value += std::sin(2.0 * M_PI * e2 * h * t + phase * h * h) / std::sqrt(double(h));
+            }
+            x[i] = float(value) + noise(generator);
+        }
+
+        PitchCandidate candidates[YinKernel::MAX_CANDIDATES];
+        int count = kernel.analyze(x.data(), candidates, YinKernel::MAX_CANDIDATES);
+        int best = -1;
+        for (int i = 0; i < count; ++i) {
+            if (best < 0 || candidates[i].probability > candidates[best].probability) best = i;
+        }
+        if (best >= 0 && std::fabs(candidates[best].frequency - e2) < 1.5) ++found;
+    }
+    QCOMPARE(found, runs);
+}
+
+void TestYinKernel::specializedMatchesGeneric_data()
+{
+    QTest::addColumn<int>("window");
+    QTest::addColumn<bool>("specialized");
+
+    // Длина интегрирования — половина окна
+    QTest::newRow("512") << 1024 << true;
+    QTest::newRow("1024") << 2048 << true;
+    QTest::newRow("2048") << 4096 << true;
+    QTest::newRow("750 (generic)") << 1500 << false;
+}
+
+// Специализированные ядра суммируют в 16 аккумуляторов, а не по порядку,
+// поэтому совпадение с общим циклом — с точностью до округления float
+void TestYinKernel::specializedMatchesGeneric()
+{
+    QFETCH(int, window);
+    QFETCH(bool, specialized);
+
+    const float rate = 48000.0f;
+    YinKernel kernel(window, rate);
+    QCOMPARE(kernel.isSpecialized(), specialized);
+    QCOMPARE(kernel.integrationSize(), window / 2);
+
+    const std::vector<float> x = testWindow(window, rate);
+    std::vector<float> diff(kernel.scratchSize(), -1.0f);
+    std::vector<float> reference(kernel.scratchSize(), -1.0f);
+    kernel.computeDifference(x.data(), diff.data());
+    YinKernel::differenceGeneric(x.data(), reference.data(), kernel.maximumLag(), kernel.integrationSize());
+
+    QCOMPARE(diff[0], 0.0f);
+    for (int tau = 1; tau <= kernel.maximumLag() + 1; ++tau) {
+        // Порядок суммирования даёт относительную ошибку порядка 1e-6;
+        // пропущенный или лишний член — порядка 1 / integrationSize
+        const float tolerance = 2e-5f * reference[tau];
+        QVERIFY2(std::fabs(diff[tau] - reference[tau]) <= tolerance,
+                 qPrintable(QString("tau %1: %2 vs %3").arg(tau).arg(diff[tau]).arg(reference[tau])));
+    }
+}
+
+// Сравнение скорости ядер на окне 2048: ./tst_yinkernel benchmarkSpecialized benchmarkGeneric
+void TestYinKernel::benchmarkSpecialized()
+{
+    const int window = 2048;
+    YinKernel kernel(window, 48000.0f);
+    QVERIFY(kernel.isSpecialized());
+    const std::vector<float> x = testWindow(window, 48000.0f);
+    std::vector<float> diff(kernel.scratchSize());
+    QBENCHMARK {
+        kernel.computeDifference(x.data(), diff.data());
+    }
+}
+
+void TestYinKernel::benchmarkGeneric()
+{
+    const int window = 2048;
+    YinKernel kernel(window, 48000.0f);
+    const std::vector<float> x = testWindow(window, 48000.0f);
+    std::vector<float> diff(kernel.scratchSize());
+    QBENCHMARK {
+        YinKernel::differenceGeneric(x.data(), diff.data(), kernel.maximumLag(), kernel.integrationSize());
+    }
+}
+
+QTEST_APPLESS_MAIN(TestYinKernel)
+
+#include "tst_yinkernel.moc"
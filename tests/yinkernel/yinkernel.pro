@@ -0,0 +1,17 @@
+QT       += testlib
+QT       -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_yinkernel
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    ../../yinkernel.cpp \
+    tst_yinkernel.cpp
+
+HEADERS += \
+    ../../simdfloat.h \
+    ../../yinkernel.h
@@ -0,0 +1,248 @@
+#include "tonegenerator.h"
+#include <QAudioSink>
+#include <QDebug>
+#include <QIODevice>
+#include <QMediaDevices>
+#include <cmath>
+#include <cstring>
+
+// Источник для режима pull: отдаёт устройству заранее отрендеренные блоки
+class ToneSource : public QIODevice
+{
+public:
+    explicit ToneSource(ToneGenerator* generator) : generator(generator) {}
+
+    qint64 bytesAvailable() const override
+    {
+        return ToneGenerator::BLOCK_FRAMES * ToneGenerator::BLOCK_COUNT * sizeof(float) + QIODevice::bytesAvailable();
+    }
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char* data, qint64 maxBytes) override { return generator->readSamples(data, maxBytes); }
+    qint64 writeData(const char*, qint64) override { return -1; }
+
+private:
+    ToneGenerator* generator;
+};
+
+ToneGenerator::ToneGenerator(QObject *parent)
+    : QObject(parent),
+    sink(nullptr),
+    source(nullptr),
+    outputThread(nullptr),
+    outputContext(nullptr),
+    renderThread(nullptr),
+    filledBlocks(BLOCK_COUNT),
+    freeBlocks(BLOCK_COUNT),
+    currentBlock(-1),
+    blockOffset(0),
+    rendering(false),
+    playing(false),
+    targetFrequency(440.0f),
+    amplitude(0.0f),
+    generation(0),
+    levelDb(-12.0f)
+{
+}
+
+ToneGenerator::~ToneGenerator()
+{
+    close();
+}
+
+void ToneGenerator::setLevel(float db)
+{
+    levelDb = db;
+    if (isPlaying()) amplitude.store(std::pow(10.0f, levelDb / 20.0f));
+}
+
+bool ToneGenerator::open()
+{
+    if (outputThread) return true;
+
+    const QAudioDevice device = QMediaDevices::defaultAudioOutput();
+    if (device.isNull()) {
+        emit errorOccurred("Не найдено устройство вывода звука.");
+        return false;
+    }
+
+    format.setSampleRate(device.preferredFormat().sampleRate());
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Float);
+    if (!device.isFormatSupported(format)) {
+        format.setSampleFormat(QAudioFormat::Int16);
+    }
+    if (!device.isFormatSupported(format)) {
+        qWarning() << "Audio output" << device.description() << "supports neither Float nor Int16 mono";
+        emit errorOccurred("Устройство вывода не поддерживает нужный формат звука.");
+        return false;
+    }
+
+    wavetable.reset(new BandLimitedWavetable(format.sampleRate()));
+    blocks.assign(BLOCK_COUNT, Block());
+    int index;
+    while (filledBlocks.pop(index)) {}
+    while (freeBlocks.pop(index)) {}
+    for (int i = 0; i < BLOCK_COUNT; ++i) {
+        blocks[i].samples.assign(BLOCK_FRAMES, 0.0f);
+        freeBlocks.push(int(i));
+    }
+    freeAvailable.acquire(freeAvailable.available());
+    freeAvailable.release(BLOCK_COUNT);
+    currentBlock = -1;
+    blockOffset = 0;
+
+    rendering.store(true);
+    renderThread = QThread::create([this]() { renderLoop(); });
+    renderThread->setObjectName("tone");
+    renderThread->start(QThread::TimeCriticalPriority);
+
+    // Устройство вывода живёт в своём потоке с циклом событий: в режиме pull Qt
+    // обслуживает его таймером потока-владельца, и занятый GUI не должен
+    // задерживать подкачку маленького буфера
+    outputThread = new QThread(this);
+    outputThread->setObjectName("tone-output");
+    outputContext = new QObject();
+    outputContext->moveToThread(outputThread);
+    connect(outputThread, &QThread::finished, outputContext, &QObject::deleteLater);
+    outputThread->start(QThread::TimeCriticalPriority);
+
+    bool started = false;
+    QMetaObject::invokeMethod(outputContext, [this, device, &started]() {
+        source = new ToneSource(this);
+        source->open(QIODevice::ReadOnly);
+        // Буфер устройства в два блока (~5 мс): задержка начала тона определяется им
+        sink = new QAudioSink(device, format);
+        sink->setBufferSize(format.bytesForFrames(BLOCK_FRAMES * 2));
+        sink->start(source);
+        started = sink->error() == QAudio::NoError;
+        if (!started) qWarning() << "Audio output failed to start:" << sink->error();
+    }, Qt::BlockingQueuedConnection);
+
+    if (!started) {
+        emit errorOccurred("Не удалось открыть вывод звука.");
+        close();
+        return false;
+    }
+    qDebug() << "Reference tone output" << device.description() << format.sampleRate() << "Hz";
+    return true;
+}
+
+void ToneGenerator::play(float frequencyHz)
+{
+    if (frequencyHz <= 0.0f || !open()) return;
+
+    targetFrequency.store(frequencyHz);
+    amplitude.store(std::pow(10.0f, levelDb / 20.0f));
+    if (!playing.exchange(true)) {
+        // Новый тон: уже отрендеренная тишина не должна задерживать его начало
+        generation.fetch_add(1);
+    }
+}
+
+void ToneGenerator::stop()
+{
+    playing.store(false);
+    amplitude.store(0.0f);
+}
+
+void ToneGenerator::close()
+{
+    stop();
+    if (outputThread) {
+        // Устройство удаляется в своём потоке, после этого поток останавливается
+        QMetaObject::invokeMethod(outputContext, [this]() {
+            if (sink) sink->stop();
+            delete sink;
+            sink = nullptr;
+            delete source;
+            source = nullptr;
+        }, Qt::BlockingQueuedConnection);
+        outputThread->quit();
+        outputThread->wait();
+        delete outputThread;
+        outputThread = nullptr;
+        outputContext = nullptr;
+    }
+    if (renderThread) {
+        rendering.store(false);
+        renderThread->wait();
+        delete renderThread;
+        renderThread = nullptr;
+    }
+}
+
+void ToneGenerator::renderLoop()
+{
+    WavetableOscillator oscillator(*wavetable, int(format.sampleRate() * 0.005f));
+    int renderedGeneration = generation.load();
+
+    while (rendering.load(std::memory_order_relaxed)) {
+        // Ждём освободившийся блок; тайм-аут — только чтобы заметить остановку
+        if (!freeAvailable.tryAcquire(1, 5)) continue;
+
+        int index;
+        freeBlocks.pop(index);
+        Block& block = blocks[index];
+
+        const int current = generation.load(std::memory_order_acquire);
+        if (current != renderedGeneration) {
+            renderedGeneration = current;
+            // Если прошлый тон ещё затухает, огибающая разворачивается с текущего
+            // уровня; с нуля и с нулевой фазы начинается только тон после тишины
+            if (oscillator.isSilent()) oscillator.restart();
+        }
+        const float blockAmplitude = amplitude.load(std::memory_order_relaxed);
+        block.silent = oscillator.isSilent() && blockAmplitude == 0.0f;
+        oscillator.render(block.samples.data(), BLOCK_FRAMES,
+                          targetFrequency.load(std::memory_order_relaxed), blockAmplitude);
+        block.generation = current;
+        filledBlocks.push(std::move(index));
+    }
+}
+
+qint64 ToneGenerator::readSamples(char* data, qint64 maxBytes)
+{
+    const int bytesPerSample = format.bytesPerSample();
+    const qint64 frames = maxBytes / bytesPerSample;
+    const int current = generation.load(std::memory_order_acquire);
+
+    for (qint64 written = 0; written < frames; ) {
+        if (currentBlock < 0) {
+            if (!filledBlocks.pop(currentBlock)) {
+                // Рендер не успел: дополняем тишиной, но отдаём запрошенное целиком
+                std::memset(data + written * bytesPerSample, 0, (frames - written) * bytesPerSample);
+                break;
+            }
+            blockOffset = 0;
+            if (blocks[currentBlock].generation != current && blocks[currentBlock].silent) {
+                // Тишина до начала нового тона
+                freeBlocks.push(std::move(currentBlock));
+                freeAvailable.release();
+                currentBlock = -1;
+                continue;
+            }
+        }
+
+        const float* samples = blocks[currentBlock].samples.data() + blockOffset;
+        const int count = int(qMin<qint64>(BLOCK_FRAMES - blockOffset, frames - written));
+        if (format.sampleFormat() == QAudioFormat::Float) {
+            std::memcpy(data + written * bytesPerSample, samples, count * sizeof(float));
+        } else {
+            qint16* out = reinterpret_cast<qint16*>(data) + written;
+            for (int i = 0; i < count; ++i) {
+                out[i] = qint16(qBound(-1.0f, samples[i], 1.0f) * 32767.0f);
+            }
+        }
+        written += count;
+        blockOffset += count;
+
+        if (blockOffset == BLOCK_FRAMES) {
+            freeBlocks.push(std::move(currentBlock));
+            freeAvailable.release();
+            currentBlock = -1;
+        }
+    }
+    return frames * bytesPerSample;
+}
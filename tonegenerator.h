@@ -0,0 +1,91 @@
+#ifndef TONEGENERATOR_H
+#define TONEGENERATOR_H
+
+#include <QObject>
+#include <QAudioFormat>
+#include <QSemaphore>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "spscqueue.h"
+#include "wavetable.h"
+
+class QAudioSink;
+class ToneSource;
+
+// Опорный тон через QAudioSink в режиме pull. Устройство обслуживается в своём
+// потоке (не в GUI), блоки по BLOCK_FRAMES отсчётов рендерятся заранее в
+// другом потоке и передаются через lock-free очереди (заполненные и свободные
+// блоки), так что поток вывода только копирует готовые отсчёты. Вывод открывается при первом play()
+// и дальше играет тишину, поэтому следующий тон начинается сразу:
+// ещё не сыгранные блоки тишины при старте тона отбрасываются.
+// Захват звука и анализ идут независимо, на своих потоках.
+class ToneGenerator : public QObject
+{
+    Q_OBJECT
+public:
+    static const int BLOCK_FRAMES = 128;  // 2.7 мс при 48 кГц
+    static const int BLOCK_COUNT = 4;     // Рендер вперёд не больше чем на ~11 мс
+
+    explicit ToneGenerator(QObject *parent = nullptr);
+    ~ToneGenerator();
+
+    // Громкость тона, dBFS
+    void setLevel(float levelDb);
+    float level() const { return levelDb; }
+
+    bool isPlaying() const { return playing.load(std::memory_order_relaxed); }
+    float frequency() const { return targetFrequency.load(std::memory_order_relaxed); }
+
+public slots:
+    // Начинает тон или меняет частоту уже звучащего (без разрыва фазы)
+    void play(float frequencyHz);
+    // Плавно гасит тон; вывод остаётся открытым
+    void stop();
+    // Закрывает устройство вывода и останавливает поток рендера
+    void close();
+
+signals:
+    void errorOccurred(const QString& message);
+
+private:
+    friend class ToneSource;
+
+    struct Block {
+        std::vector<float> samples;
+        int generation = 0;
+        // Одни нули: при старте нового тона такой блок пропускается. Затухание
+        // прошлого тона доигрывается, иначе обрыв даёт щелчок
+        bool silent = true;
+    };
+
+    bool open();
+    void renderLoop();
+    // Вызывается таймером QAudioSink в outputThread
+    qint64 readSamples(char* data, qint64 maxBytes);
+
+    QAudioFormat format;
+    QAudioSink *sink;          // Создаётся и живёт в outputThread
+    ToneSource *source;
+    QThread *outputThread;
+    QObject *outputContext;
+    QThread *renderThread;
+    std::unique_ptr<BandLimitedWavetable> wavetable;
+
+    std::vector<Block> blocks;
+    SpscQueue<int> filledBlocks;
+    SpscQueue<int> freeBlocks;
+    QSemaphore freeAvailable;
+    int currentBlock;
+    int blockOffset;
+
+    std::atomic<bool> rendering;
+    std::atomic<bool> playing;
+    std::atomic<float> targetFrequency;
+    std::atomic<float> amplitude;
+    std::atomic<int> generation;
+    float levelDb;
+};
+
+#endif // TONEGENERATOR_H
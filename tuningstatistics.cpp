@@ -0,0 +1,120 @@
+#include "tuningstatistics.h"
+#include <QDateTime>
+#include <QDebug>
+#include <cmath>
+
+TuningStatistics::TuningStatistics(QObject *parent)
+    : QObject(parent),
+    logThread(nullptr),
+    writer(nullptr)
+{
+    connect(&intervalTimer, &QTimer::timeout, this, &TuningStatistics::flushInterval);
+}
+
+TuningStatistics::~TuningStatistics()
+{
+    stopLog();
+}
+
+void TuningStatistics::addReading(const QString& string, float cents)
+{
+    if (string.isEmpty() || std::isnan(cents)) return;
+
+    StringStatistics& entry = statistics[string];
+    if (!(qAbs(cents) <= MAX_DEVIATION_CENTS)) {
+        ++entry.rejected;
+        ++entry.intervalRejected;
+        return;
+    }
+    entry.total.add(cents);
+    entry.interval.add(cents);
+}
+
+void TuningStatistics::reset()
+{
+    statistics.clear();
+}
+
+bool TuningStatistics::startLog(const QString& path, int intervalSeconds, qint64 maxFileBytes)
+{
+    stopLog();
+
+    writer = new DriftLogWriter();
+    if (!writer->open(path, maxFileBytes)) {
+        delete writer;
+        writer = nullptr;
+        return false;
+    }
+
+    logThread = new QThread(this);
+    writer->moveToThread(logThread);
+    connect(logThread, &QThread::finished, writer, &QObject::deleteLater);
+    logThread->start(QThread::LowPriority);
+
+    // Прошлые показания в первый интервал не попадают
+    for (StringStatistics& entry : statistics) {
+        entry.interval.reset();
+        entry.intervalRejected = 0;
+    }
+
+    intervalTimer.start(qMax(1, intervalSeconds) * 1000);
+    qDebug() << "Drift log" << path << "every" << intervalSeconds << "s";
+    return true;
+}
+
+void TuningStatistics::stopLog()
+{
+    if (!writer) return;
+
+    // Незаконченный интервал тоже попадает в журнал
+    flushInterval();
+    intervalTimer.stop();
+
+    DriftLogWriter *oldWriter = writer;
+    writer = nullptr;
+    // Блокирующий вызов: очередь записи успевает опустеть до остановки потока
+    QMetaObject::invokeMethod(oldWriter, &DriftLogWriter::close, Qt::BlockingQueuedConnection);
+    logThread->quit();
+    logThread->wait();
+    delete logThread;
+    logThread = nullptr;
+}
+
+void TuningStatistics::flushInterval()
+{
+    if (!writer) return;
+
+    QVector<DriftRecord> records;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = statistics.begin(); it != statistics.end(); ++it) {
+        RunningStatistics& interval = it.value().interval;
+        if (interval.count() == 0 && it.value().intervalRejected == 0) continue;
+
+        const RunningStatistics& total = it.value().total;
+        DriftRecord record;
+        record.timeMs = now;
+        record.string = it.key();
+        record.count = interval.count();
+        record.meanCents = interval.mean();
+        record.stdDevCents = interval.standardDeviation();
+        record.p5Cents = interval.percentile5();
+        record.medianCents = interval.median();
+        record.p95Cents = interval.percentile95();
+        record.totalCount = total.count();
+        record.totalMeanCents = total.mean();
+        record.totalStdDevCents = total.standardDeviation();
+        record.rejected = it.value().intervalRejected;
+        record.totalRejected = it.value().rejected;
+        records.append(record);
+
+        interval.reset();
+        it.value().intervalRejected = 0;
+    }
+    if (records.isEmpty()) return;
+
+    // Форматирование и запись — в потоке журнала, GUI только копирует итоги
+    DriftLogWriter *target = writer;
+    QMetaObject::invokeMethod(writer, [target, records]() {
+        target->write(records);
+    }, Qt::QueuedConnection);
+}
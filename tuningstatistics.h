@@ -0,0 +1,56 @@
+#ifndef TUNINGSTATISTICS_H
+#define TUNINGSTATISTICS_H
+
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+#include "driftlogwriter.h"
+#include "runningstatistics.h"
+
+// Статистика отклонения в центах по струнам для долгих испытаний стабильности.
+// Каждое показание попадает в накопители за всё время и за текущий интервал;
+// раз в интервал итоги уходят в журнал дрейфа, а интервальные накопители
+// обнуляются. Память не зависит от длительности: O(1) на струну.
+class TuningStatistics : public QObject
+{
+    Q_OBJECT
+public:
+    struct StringStatistics {
+        RunningStatistics total;
+        RunningStatistics interval;
+        // Показания дальше MAX_DEVIATION_CENTS: в среднее не входят, но считаются,
+        // чтобы сильно расстроенная струна была видна в статистике
+        long long rejected = 0;
+        long long intervalRejected = 0;
+    };
+
+    // Показания дальше этого считаются другой нотой и не усредняются
+    static constexpr float MAX_DEVIATION_CENTS = 50.0f;
+
+    explicit TuningStatistics(QObject *parent = nullptr);
+    ~TuningStatistics();
+
+    // string — имя ноты ("A2"), одно и то же в ручном режиме и в автопоиске
+    void addReading(const QString& string, float cents);
+    const QMap<QString, StringStatistics>& strings() const { return statistics; }
+    void reset();
+
+    // Журнал дрейфа: строка на струну раз в intervalSeconds, запись в фоновом потоке.
+    // maxFileBytes — порог ротации файла (0 — без ротации).
+    bool startLog(const QString& path, int intervalSeconds = 10, qint64 maxFileBytes = 8 * 1024 * 1024);
+    void stopLog();
+    bool isLogging() const { return writer != nullptr; }
+
+private slots:
+    void flushInterval();
+
+private:
+    QMap<QString, StringStatistics> statistics;
+    QTimer intervalTimer;
+    QThread *logThread;
+    DriftLogWriter *writer;
+};
+
+#endif // TUNINGSTATISTICS_H
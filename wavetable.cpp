@@ -0,0 +1,86 @@
+#include "wavetable.h"
+#include <algorithm>
+#include <cmath>
+
+BandLimitedWavetable::BandLimitedWavetable(float sampleRate, float lowestFrequency)
+    : rate(sampleRate),
+    lowest(lowestFrequency)
+{
+    const double twoPi = 6.283185307179586;
+
+    // Октавы от lowest до Найквиста; верхняя частота октавы k — lowest * 2^(k+1)
+    for (float top = lowest * 2.0f; ; top *= 2.0f) {
+        int harmonics = std::min(MAX_HARMONICS, std::max(1, int(rate / 2.0f / top)));
+
+        std::vector<float> table(TABLE_SIZE + 1);
+        float peak = 0.0f;
+        for (int i = 0; i < TABLE_SIZE; ++i) {
+            double x = twoPi * i / TABLE_SIZE;
+            double value = 0.0;
+            for (int n = 1; n <= harmonics; ++n) {
+                value += std::sin(n * x) / double(n * n);
+            }
+            table[i] = float(value);
+            peak = std::max(peak, std::fabs(table[i]));
+        }
+        for (int i = 0; i < TABLE_SIZE; ++i) table[i] /= peak;
+        table[TABLE_SIZE] = table[0];
+        tables.push_back(std::move(table));
+
+        if (top >= rate / 2.0f) break;
+    }
+}
+
+const float* BandLimitedWavetable::tableFor(float frequency) const
+{
+    int octave = 0;
+    for (float top = lowest * 2.0f; frequency > top && octave + 1 < int(tables.size()); top *= 2.0f) {
+        ++octave;
+    }
+    return tables[octave].data();
+}
+
+WavetableOscillator::WavetableOscillator(const BandLimitedWavetable& wavetable, int fadeSamples)
+    : wavetable(wavetable),
+    phase(0),
+    envelope(0.0f),
+    target(0.0f),
+    fadeAmplitude(1.0f),
+    fadeStep(1.0f / std::max(1, fadeSamples))
+{
+}
+
+void WavetableOscillator::restart()
+{
+    phase = 0;
+    envelope = 0.0f;
+}
+
+void WavetableOscillator::render(float* out, int frames, float frequency, float amplitude)
+{
+    target = amplitude;
+    // Скорость огибающей — от последней ненулевой громкости, чтобы затухание было линейным
+    if (amplitude > 0.0f) fadeAmplitude = amplitude;
+    if (isSilent() || frequency <= 0.0f) {
+        std::fill(out, out + frames, 0.0f);
+        return;
+    }
+
+    const float* table = wavetable.tableFor(frequency);
+    const uint32_t increment = uint32_t(double(frequency) / wavetable.sampleRate() * 4294967296.0);
+    const int fractionBits = 32 - BandLimitedWavetable::TABLE_BITS;
+    const float fractionScale = 1.0f / float(1u << fractionBits);
+    const float step = std::max(fadeStep * std::max(fadeAmplitude, envelope), 1e-6f);
+
+    for (int i = 0; i < frames; ++i) {
+        // Линейная огибающая к целевой громкости
+        if (envelope < target) envelope = std::min(target, envelope + step);
+        else if (envelope > target) envelope = std::max(target, envelope - step);
+
+        const uint32_t index = phase >> fractionBits;
+        const float fraction = (phase & ((1u << fractionBits) - 1)) * fractionScale;
+        const float sample = table[index] + fraction * (table[index + 1] - table[index]);
+        out[i] = envelope * sample;
+        phase += increment;
+    }
+}
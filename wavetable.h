@@ -0,0 +1,54 @@
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+#include <cstdint>
+#include <vector>
+
+// Набор таблиц одного периода, по таблице на октаву основного тона.
+// В таблицу октавы входят только гармоники ниже Найквиста для её верхней
+// частоты, поэтому при чтении с любым шагом нет наложения спектров.
+// Тембр мягкий: амплитуда n-й гармоники 1/n², как у треугольника без смены знака.
+class BandLimitedWavetable
+{
+public:
+    static const int TABLE_BITS = 11;
+    static const int TABLE_SIZE = 1 << TABLE_BITS;
+    static const int MAX_HARMONICS = 64;
+
+    explicit BandLimitedWavetable(float sampleRate, float lowestFrequency = 20.0f);
+
+    // Таблица на TABLE_SIZE + 1 отсчёт (последний повторяет первый для интерполяции)
+    const float* tableFor(float frequency) const;
+    float sampleRate() const { return rate; }
+
+private:
+    float rate;
+    float lowest;
+    std::vector<std::vector<float>> tables;
+};
+
+// Генератор с фазовым аккумулятором (32 бита фиксированной точкой) и
+// линейной интерполяцией по таблице. Амплитуда меняется плавно за fadeSamples,
+// чтобы включение, выключение и смена уровня не давали щелчков.
+class WavetableOscillator
+{
+public:
+    WavetableOscillator(const BandLimitedWavetable& wavetable, int fadeSamples);
+
+    // Сброс фазы и огибающей: следующий тон начнётся с нуля
+    void restart();
+    // amplitude — целевая громкость (0 — тишина)
+    void render(float* out, int frames, float frequency, float amplitude);
+
+    bool isSilent() const { return envelope == 0.0f && target == 0.0f; }
+
+private:
+    const BandLimitedWavetable& wavetable;
+    uint32_t phase;
+    float envelope;
+    float target;
+    float fadeAmplitude;
+    float fadeStep;
+};
+
+#endif // WAVETABLE_H
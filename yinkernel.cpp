@@ -0,0 +1,201 @@
+#include "yinkernel.h"
+#include "simdfloat.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+const int THRESHOLD_COUNT = 100;
+// Beta(2, 18): среднее значение порога 0.1, как в pYIN
+const float PRIOR_ALPHA = 2.0f;
+const float PRIOR_BETA = 18.0f;
+// Доля вероятности, отдаваемая глобальному минимуму, если порог не пройден
+const float GLOBAL_MINIMUM_WEIGHT = 0.01f;
+}
+
+YinKernel::YinKernel(int windowSize, float sampleRate, float minFrequency, float maxFrequency)
+    : window(windowSize),
+    rate(sampleRate),
+    integrationLength(windowSize / 2),
+    minLag(2),
+    maxLag(windowSize / 2 - 1)
+{
+    // Лаг на единицу шире диапазона, чтобы крайний минимум был локальным
+    if (maxFrequency > 0.0f) {
+        minLag = std::max(minLag, int(std::floor(sampleRate / maxFrequency)) - 1);
+    }
+    if (minFrequency > 0.0f) {
+        maxLag = std::min(maxLag, int(std::ceil(sampleRate / minFrequency)) + 1);
+    }
+    maxLag = std::max(maxLag, minLag);
+    scratch.assign(scratchSize(), 0.0f);
+
+    switch (integrationLength) {
+    case 512:  difference = &YinKernel::differenceFixed<512>; break;
+    case 1024: difference = &YinKernel::differenceFixed<1024>; break;
+    case 2048: difference = &YinKernel::differenceFixed<2048>; break;
+    default:   difference = &YinKernel::differenceGeneric; break;
+    }
+
+    thresholds.resize(THRESHOLD_COUNT);
+    thresholdPrior.resize(THRESHOLD_COUNT);
+
+    float total = 0.0f;
+    for (int i = 0; i < THRESHOLD_COUNT; ++i) {
+        float s = (i + 1) / float(THRESHOLD_COUNT);
+        thresholds[i] = s;
+        thresholdPrior[i] = std::pow(s, PRIOR_ALPHA - 1.0f) * std::pow(1.0f - s, PRIOR_BETA - 1.0f);
+        total += thresholdPrior[i];
+    }
+    for (float& p : thresholdPrior) {
+        p /= total;
+    }
+}
+
+void YinKernel::differenceGeneric(const float* x, float* diff, int maxLag, int integrationLength)
+{
+    diff[0] = 0.0f;
+    for (int tau = 1; tau <= maxLag + 1; ++tau) {
+        float sum = 0.0f;
+        for (int j = 0; j < integrationLength; ++j) {
+            float d = x[j] - x[j + tau];
+            sum += d * d;
+        }
+        diff[tau] = sum;
+    }
+}
+
+template<int IntegrationLength>
+void YinKernel::differenceFixed(const float* x, float* diff, int maxLag, int)
+{
+    // Четыре независимых аккумулятора по 4 канала скрывают задержку сложения
+    static_assert(IntegrationLength % 16 == 0, "integration length must be a multiple of 16");
+
+    diff[0] = 0.0f;
+    for (int tau = 1; tau <= maxLag + 1; ++tau) {
+        const float* y = x + tau;
+        SimdFloat4 acc0 = SimdFloat4::zero();
+        SimdFloat4 acc1 = SimdFloat4::zero();
+        SimdFloat4 acc2 = SimdFloat4::zero();
+        SimdFloat4 acc3 = SimdFloat4::zero();
+        for (int j = 0; j < IntegrationLength; j += 16) {
+            SimdFloat4 d0 = SimdFloat4::load(x + j) - SimdFloat4::load(y + j);
+            SimdFloat4 d1 = SimdFloat4::load(x + j + 4) - SimdFloat4::load(y + j + 4);
+            SimdFloat4 d2 = SimdFloat4::load(x + j + 8) - SimdFloat4::load(y + j + 8);
+            SimdFloat4 d3 = SimdFloat4::load(x + j + 12) - SimdFloat4::load(y + j + 12);
+            acc0 = acc0 + d0 * d0;
+            acc1 = acc1 + d1 * d1;
+            acc2 = acc2 + d2 * d2;
+            acc3 = acc3 + d3 * d3;
+        }
+        diff[tau] = ((acc0 + acc1) + (acc2 + acc3)).sum();
+    }
+}
+
+void YinKernel::computeDifference(const float* x, float* diff) const
+{
+    difference(x, diff, maxLag, integrationLength);
+}
+
+void YinKernel::cumulativeMeanNormalize(float* diff) const
+{
+    float running = 0.0f;
+    diff[0] = 1.0f;
+    for (int tau = 1; tau <= maxLag + 1; ++tau) {
+        running += diff[tau];
+        diff[tau] = running > 0.0f ? diff[tau] * tau / running : 1.0f;
+    }
+}
+
+float YinKernel::interpolatedLag(const float* diff, int tau) const
+{
+    float left = diff[tau - 1];
+    float center = diff[tau];
+    float right = diff[tau + 1];
+    float denominator = left - 2.0f * center + right;
+    if (std::fabs(denominator) < 1e-12f) return float(tau);
+    return tau + 0.5f * (left - right) / denominator;
+}
+
+int YinKernel::analyze(const float* x, PitchCandidate* out, int maxCount)
+{
+    return analyze(x, scratch.data(), out, maxCount);
+}
+
+int YinKernel::analyze(const float* x, float* diff, PitchCandidate* out, int maxCount) const
+{
+    computeDifference(x, diff);
+    return candidatesFromDifference(diff, out, maxCount);
+}
+
+int YinKernel::candidatesFromDifference(float* diff, PitchCandidate* out, int maxCount) const
+{
+    cumulativeMeanNormalize(diff);
+
+    // Каждый порог голосует за первый (по лагу) минимум ниже себя. Пороги
+    // возрастают, поэтому ещё не проголосовавшие — всегда префикс [0, pending):
+    // очередной минимум забирает пороги выше своего значения. Просматриваются
+    // все минимумы диапазона — у яркой низкой ноты до истинного периода
+    // бывают десятки мелких впадин от гармоник и шума.
+    int firstTrough[THRESHOLD_COUNT];
+    int pending = THRESHOLD_COUNT;
+    int globalMinimum = -1;
+
+    for (int tau = minLag; tau <= maxLag; ++tau) {
+        if (!(diff[tau] < diff[tau - 1] && diff[tau] <= diff[tau + 1])) continue;
+
+        if (globalMinimum < 0 || diff[tau] < diff[globalMinimum]) globalMinimum = tau;
+        while (pending > 0 && diff[tau] < thresholds[pending - 1]) {
+            firstTrough[--pending] = tau;
+        }
+    }
+    if (globalMinimum < 0) return 0;
+
+    // Голоса по минимумам; от высоких порогов к низким лаги не убывают
+    int troughs[THRESHOLD_COUNT + 1];
+    float troughProbability[THRESHOLD_COUNT + 1];
+    int troughCount = 0;
+    for (int i = THRESHOLD_COUNT - 1; i >= pending; --i) {
+        if (troughCount == 0 || troughs[troughCount - 1] != firstTrough[i]) {
+            troughs[troughCount] = firstTrough[i];
+            troughProbability[troughCount++] = 0.0f;
+        }
+        troughProbability[troughCount - 1] += thresholdPrior[i];
+    }
+    // Не пройденные ни одним минимумом пороги отдают малую долю глобальному
+    if (pending > 0) {
+        float weight = 0.0f;
+        for (int i = 0; i < pending; ++i) weight += thresholdPrior[i] * GLOBAL_MINIMUM_WEIGHT;
+
+        int k = 0;
+        while (k < troughCount && troughs[k] < globalMinimum) ++k;
+        if (k < troughCount && troughs[k] == globalMinimum) {
+            troughProbability[k] += weight;
+        } else {
+            std::move_backward(troughs + k, troughs + troughCount, troughs + troughCount + 1);
+            std::move_backward(troughProbability + k, troughProbability + troughCount,
+                               troughProbability + troughCount + 1);
+            troughs[k] = globalMinimum;
+            troughProbability[k] = weight;
+            ++troughCount;
+        }
+    }
+
+    // Если минимумов с голосами больше maxCount, остаются самые вероятные (в порядке лага)
+    float cutoff = 0.0f;
+    if (troughCount > maxCount) {
+        float sorted[THRESHOLD_COUNT + 1];
+        std::copy(troughProbability, troughProbability + troughCount, sorted);
+        std::nth_element(sorted, sorted + maxCount - 1, sorted + troughCount, std::greater<float>());
+        cutoff = sorted[maxCount - 1];
+    }
+
+    int count = 0;
+    for (int i = 0; i < troughCount && count < maxCount; ++i) {
+        if (troughProbability[i] <= 0.0f || troughProbability[i] < cutoff) continue;
+        out[count].frequency = rate / interpolatedLag(diff, troughs[i]);
+        out[count].probability = troughProbability[i];
+        ++count;
+    }
+    return count;
+}
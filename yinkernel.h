@@ -0,0 +1,74 @@
+#ifndef YINKERNEL_H
+#define YINKERNEL_H
+
+#include <vector>
+
+struct PitchCandidate {
+    float frequency;
+    float probability;
+};
+
+// Нативная реализация YIN, выдающая несколько кандидатов питча
+// с вероятностями (как в pYIN): порог абсолютного минимума не фиксирован,
+// а пробегает распределение Beta, и каждый порог голосует за свой минимум.
+class YinKernel
+{
+public:
+    static const int MAX_CANDIDATES = 16;
+
+    // minFrequency/maxFrequency ограничивают поиск лагов (0 — без ограничения).
+    // Нижняя граница сокращает расчёт разностной функции, верхняя отсекает
+    // кандидатов выше диапазона инструмента (ошибки на октаву вверх).
+    YinKernel(int windowSize, float sampleRate, float minFrequency = 0.0f, float maxFrequency = 0.0f);
+
+    // window — windowSize последних отсчётов, от старых к новым.
+    // Возвращает число кандидатов; сумма их вероятностей — вероятность вокализации.
+    int analyze(const float* window, PitchCandidate* out, int maxCount);
+    // То же с внешним буфером на scratchSize() отсчётов: одно ядро можно
+    // использовать для многих каналов и потоков одновременно
+    int analyze(const float* window, float* externalScratch, PitchCandidate* out, int maxCount) const;
+
+    // Кандидаты по уже посчитанной разностной функции d[0..scratchSize() - 1]
+    // (например, обновляемой инкрементально). diff перезаписывается.
+    int candidatesFromDifference(float* diff, PitchCandidate* out, int maxCount) const;
+
+    int windowSize() const { return window; }
+    float sampleRate() const { return rate; }
+    int scratchSize() const { return maxLag + 2; }
+    // Границы поиска после ограничения диапазоном: d(tau) нужна для tau в [1, maxLag + 1]
+    int integrationSize() const { return integrationLength; }
+    int minimumLag() const { return minLag; }
+    int maximumLag() const { return maxLag; }
+
+    // Есть ли для этого окна специализированное ядро разностной функции
+    bool isSpecialized() const { return difference != &YinKernel::differenceGeneric; }
+
+    // Разностная функция d[0..maxLag + 1] выбранным для окна ядром
+    void computeDifference(const float* x, float* diff) const;
+    // Общий случай: длина интегрирования известна только во время выполнения.
+    // Открыт как эталон для проверки специализированных ядер
+    static void differenceGeneric(const float* x, float* diff, int maxLag, int integrationLength);
+
+private:
+    typedef void (*DifferenceFunction)(const float* x, float* diff, int maxLag, int integrationLength);
+
+    // Окна 1024/2048/4096: число итераций известно компилятору, цикл без остатка
+    template<int IntegrationLength>
+    static void differenceFixed(const float* x, float* diff, int maxLag, int integrationLength);
+
+    void cumulativeMeanNormalize(float* diff) const;
+    float interpolatedLag(const float* diff, int tau) const;
+
+    int window;
+    float rate;
+    int integrationLength;
+    int minLag;
+    int maxLag;
+    DifferenceFunction difference;
+
+    std::vector<float> scratch;
+    std::vector<float> thresholds;
+    std::vector<float> thresholdPrior;
+};
+
+#endif // YINKERNEL_H